@@ -0,0 +1,63 @@
+# Usage: cmake -DJSON=<path> -P check_comm_json.cmake <command>...
+# Runs the command, which should write the communication counters
+# of --osh-comm-json to JSON, and checks that every entry has
+# all of the counters, as well as that the indset and distributor
+# counters are present.
+
+set(COMMAND)
+set(AFTER_SCRIPT FALSE)
+math(EXPR LAST_ARG "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${LAST_ARG})
+  if(AFTER_SCRIPT)
+    list(APPEND COMMAND "${CMAKE_ARGV${i}}")
+  elseif("${CMAKE_ARGV${i}}" STREQUAL "-P")
+    math(EXPR SCRIPT_ARG "${i} + 1")
+  elseif(DEFINED SCRIPT_ARG AND i EQUAL SCRIPT_ARG)
+    set(AFTER_SCRIPT TRUE)
+  endif()
+endforeach()
+list(LENGTH COMMAND NCOMMAND_ARGS)
+if(NCOMMAND_ARGS EQUAL 0)
+  message(FATAL_ERROR "no command to run")
+endif()
+
+file(REMOVE "${JSON}")
+execute_process(COMMAND ${COMMAND} RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+  message(FATAL_ERROR "\"${COMMAND}\" failed: ${RESULT}")
+endif()
+if(NOT EXISTS "${JSON}")
+  message(FATAL_ERROR "\"${COMMAND}\" did not write ${JSON}")
+endif()
+
+file(STRINGS "${JSON}" ENTRIES REGEX "\"site\"")
+list(LENGTH ENTRIES NENTRIES)
+if(NENTRIES EQUAL 0)
+  message(FATAL_ERROR "${JSON} has no entries")
+endif()
+set(NUMBER "[-+0-9.eE]+")
+foreach(ENTRY IN LISTS ENTRIES)
+  foreach(KEY site op)
+    if(NOT ENTRY MATCHES "\"${KEY}\": \"[^\"]+\"")
+      message(FATAL_ERROR "entry lacks \"${KEY}\": ${ENTRY}")
+    endif()
+  endforeach()
+  if(NOT ENTRY MATCHES "\"calls\": [1-9][0-9]*")
+    message(FATAL_ERROR "entry lacks a positive \"calls\": ${ENTRY}")
+  endif()
+  foreach(KEY messages neighbors sent_bytes received_bytes)
+    if(NOT ENTRY MATCHES "\"${KEY}\": [0-9]+")
+      message(FATAL_ERROR "entry lacks \"${KEY}\": ${ENTRY}")
+    endif()
+  endforeach()
+  foreach(KEY max_time mean_time imbalance)
+    if(NOT ENTRY MATCHES "\"${KEY}\": ${NUMBER}")
+      message(FATAL_ERROR "entry lacks \"${KEY}\": ${ENTRY}")
+    endif()
+  endforeach()
+endforeach()
+foreach(SITE find_indset "Dist::set_dest_ranks")
+  if(NOT ENTRIES MATCHES "\"site\": \"${SITE}\"")
+    message(FATAL_ERROR "${JSON} has no counters for ${SITE}")
+  endif()
+endforeach()
@@ -51,8 +51,25 @@ int main(int argc, char** argv) {
   Now t0 = now();
   add_solution(&mesh);
   add_metric(&mesh);
+  {
+    auto budget_mesh = mesh;
+    auto budget_opts = opts;
+    budget_opts.verbosity = SILENT;
+    budget_opts.max_rebuilds = 1;
+    AdaptStats stats;
+    adapt(&budget_mesh, budget_opts, &stats);
+    OMEGA_H_CHECK(stats.stopped_early);
+    OMEGA_H_CHECK(stats.nrebuilds == 1);
+  }
   while (1) {
-    adapt(&mesh, opts);
+    AdaptStats stats;
+    adapt(&mesh, opts, &stats);
+    OMEGA_H_CHECK(stats.nelems_after == mesh.nglobal_ents(mesh.dim()));
+    OMEGA_H_CHECK(stats.nverts_after == mesh.nglobal_ents(VERT));
+    OMEGA_H_CHECK(stats.nelems_after - stats.nelems_before ==
+                  stats.nrefined_edges - stats.ncoarsened_verts);
+    /* nothing changes ranks when there is only one */
+    if (world->size() == 1) OMEGA_H_CHECK(stats.nbytes_migrated == 0);
     mesh.set_parting(OMEGA_H_GHOSTED);
     add_solution(&mesh);
     mesh.remove_tag(VERT, "metric");
@@ -9,6 +9,7 @@
 #include "Omega_h_histogram.hpp"
 #include "Omega_h_laplace.hpp"
 #include "Omega_h_map.hpp"
+#include "Omega_h_metric.hpp"
 #include "Omega_h_motion.hpp"
 #include "Omega_h_quality.hpp"
 #include "Omega_h_refine.hpp"
@@ -68,12 +69,18 @@ AdaptOpts::AdaptOpts(Int dim) {
 #endif
   max_motion_steps = 100;
   motion_step_size = 0.1;
+  should_move_with_gradient = false;
   should_refine = true;
+  should_refine_with_templates = false;
+  should_store_log_metric = false;
+  should_cache_mident_metrics = false;
   should_coarsen = true;
   should_swap = true;
   should_coarsen_slivers = true;
   should_move_for_quality = false;
   should_allow_pinching = false;
+  max_time = ArithTraits<Real>::max();
+  max_rebuilds = ArithTraits<Int>::max();
   xfer_opts.should_conserve_size = false;
 }
 
@@ -93,6 +100,27 @@ Real min_fixable_quality(Mesh* mesh, AdaptOpts const& opts) {
 
 AdaptOpts::AdaptOpts(Mesh* mesh) : AdaptOpts(mesh->dim()) {}
 
+AdaptStats::AdaptStats() {
+  lengths_time = 0.0;
+  quality_time = 0.0;
+  snapping_time = 0.0;
+  conservation_time = 0.0;
+  total_time = 0.0;
+  nrebuilds = 0;
+  stopped_early = false;
+  nrefined_edges = 0;
+  ncoarsened_verts = 0;
+  nswapped_edges = 0;
+  nmoved_verts = 0;
+  nelems_before = 0;
+  nelems_after = 0;
+  nverts_before = 0;
+  nverts_after = 0;
+  nbytes_migrated = 0;
+  quality.min = quality.max = 0.0;
+  length.min = length.max = 0.0;
+}
+
 static void adapt_summary(Mesh* mesh, AdaptOpts const& opts,
     MinMax<Real> qualstats, MinMax<Real> lenstats) {
   print_goal_stats(mesh, "quality", mesh->dim(),
@@ -102,9 +130,22 @@ static void adapt_summary(Mesh* mesh, AdaptOpts const& opts,
       {opts.min_length_desired, opts.max_length_desired}, lenstats);
 }
 
-bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts) {
-  auto qualstats = get_minmax(mesh->comm(), get_fixable_qualities(mesh, opts));
-  auto lenstats = get_minmax(mesh->comm(), mesh->ask_lengths());
+/* queues the global extrema of fixable element qualities
+   and edge lengths onto (batch) */
+static void add_goal_extrema(Mesh* mesh, AdaptOpts const& opts,
+    ReduceBatch* batch, MinMax<Real>* qualstats, MinMax<Real>* lenstats) {
+  auto quals = get_fixable_qualities(mesh, opts);
+  auto lens = mesh->ask_lengths();
+  *qualstats = {get_min(quals), get_max(quals)};
+  *lenstats = {get_min(lens), get_max(lens)};
+  batch->add(&qualstats->min, OMEGA_H_MIN);
+  batch->add(&qualstats->max, OMEGA_H_MAX);
+  batch->add(&lenstats->min, OMEGA_H_MIN);
+  batch->add(&lenstats->max, OMEGA_H_MAX);
+}
+
+static bool report_adapt_status(Mesh* mesh, AdaptOpts const& opts,
+    MinMax<Real> qualstats, MinMax<Real> lenstats) {
   if (opts.verbosity > SILENT) {
     adapt_summary(mesh, opts, qualstats, lenstats);
   }
@@ -113,6 +154,14 @@ bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts) {
           lenstats.max <= opts.max_length_desired);
 }
 
+bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts) {
+  MinMax<Real> qualstats, lenstats;
+  ReduceBatch batch;
+  add_goal_extrema(mesh, opts, &batch, &qualstats, &lenstats);
+  batch.allreduce(mesh->comm());
+  return report_adapt_status(mesh, opts, qualstats, lenstats);
+}
+
 void print_adapt_histograms(Mesh* mesh, AdaptOpts const& opts) {
   auto qh = get_histogram(mesh, mesh->dim(), opts.nquality_histogram_bins, 0.0,
       1.0, mesh->ask_qualities());
@@ -125,13 +174,13 @@ void print_adapt_histograms(Mesh* mesh, AdaptOpts const& opts) {
   }
 }
 
-static void validate(Mesh* mesh, AdaptOpts const& opts) {
+/* (mq) is the value of min_fixable_quality() */
+static void validate(Mesh* mesh, AdaptOpts const& opts, Real mq) {
   OMEGA_H_CHECK(0.0 <= opts.min_quality_allowed);
   OMEGA_H_CHECK(opts.min_quality_allowed <= opts.min_quality_desired);
   OMEGA_H_CHECK(opts.min_quality_desired <= 1.0);
   OMEGA_H_CHECK(opts.nsliver_layers >= 0);
   OMEGA_H_CHECK(opts.nsliver_layers < 100);
-  auto mq = min_fixable_quality(mesh, opts);
   if (mq < opts.min_quality_allowed && !mesh->comm()->rank()) {
     std::cout << "WARNING: worst input element has quality " << mq
               << " but minimum allowed is " << opts.min_quality_allowed << "\n";
@@ -139,12 +188,16 @@ static void validate(Mesh* mesh, AdaptOpts const& opts) {
 }
 
 static bool pre_adapt(Mesh* mesh, AdaptOpts const& opts) {
-  validate(mesh, opts);
+  MinMax<Real> qualstats, lenstats;
+  ReduceBatch batch;
+  add_goal_extrema(mesh, opts, &batch, &qualstats, &lenstats);
+  batch.allreduce(mesh->comm());
+  validate(mesh, opts, qualstats.min);
   opts.xfer_opts.validate(mesh);
   if (opts.verbosity >= EACH_ADAPT && !mesh->comm()->rank()) {
     std::cout << "before adapting:\n";
   }
-  if (print_adapt_status(mesh, opts)) return false;
+  if (report_adapt_status(mesh, opts, qualstats, lenstats)) return false;
   if (opts.verbosity >= EXTRA_STATS) print_adapt_histograms(mesh, opts);
   if ((opts.verbosity >= EACH_REBUILD) && !mesh->comm()->rank()) {
     std::cout << "addressing edge lengths\n";
@@ -152,41 +205,71 @@ static bool pre_adapt(Mesh* mesh, AdaptOpts const& opts) {
   return true;
 }
 
-static void post_rebuild(Mesh* mesh, AdaptOpts const& opts) {
+/* the elapsed time is reduced so that all ranks agree to stop */
+static bool is_over_budget(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats, Now t0) {
+  if (stats->stopped_early) return true;
+  bool is_over = (stats->nrebuilds >= opts.max_rebuilds);
+  if (!is_over && opts.max_time < ArithTraits<Real>::max()) {
+    auto elapsed = mesh->comm()->allreduce(Real(now() - t0), OMEGA_H_MAX);
+    is_over = (elapsed >= opts.max_time);
+  }
+  if (is_over) {
+    stats->stopped_early = true;
+    if ((opts.verbosity > SILENT) && !mesh->comm()->rank()) {
+      std::cout << "adapt() ran out of its time or rebuild budget\n";
+    }
+  }
+  return is_over;
+}
+
+/* returns false if adapt() should stop */
+static bool post_rebuild(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats, Now t0) {
+  ++stats->nrebuilds;
   if (opts.verbosity >= EACH_REBUILD) print_adapt_status(mesh, opts);
+  return !is_over_budget(mesh, opts, stats, t0);
 }
 
-static void satisfy_lengths(Mesh* mesh, AdaptOpts const& opts) {
+static void satisfy_lengths(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats, Now t0) {
   bool did_anything;
   do {
     did_anything = false;
-    if (opts.should_refine && refine_by_size(mesh, opts)) {
-      post_rebuild(mesh, opts);
+    if (opts.should_refine && refine_by_size(mesh, opts, stats)) {
+      if (!post_rebuild(mesh, opts, stats, t0)) return;
       did_anything = true;
     }
-    if (opts.should_coarsen && coarsen_by_size(mesh, opts)) {
-      post_rebuild(mesh, opts);
+    if (opts.should_coarsen && coarsen_by_size(mesh, opts, stats)) {
+      if (!post_rebuild(mesh, opts, stats, t0)) return;
       did_anything = true;
     }
   } while (did_anything);
 }
 
-static void satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
-  if (min_fixable_quality(mesh, opts) >= opts.min_quality_desired) return;
+static void satisfy_quality(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats, Now t0) {
+  if (stats->stopped_early) return;
+  auto t1 = now();
+  if (min_fixable_quality(mesh, opts) >= opts.min_quality_desired) {
+    stats->quality_time += now() - t1;
+    return;
+  }
   if ((opts.verbosity >= EACH_REBUILD) && !mesh->comm()->rank()) {
     std::cout << "addressing element qualities\n";
   }
   do {
-    if (opts.should_swap && swap_edges(mesh, opts)) {
-      post_rebuild(mesh, opts);
+    if (opts.should_swap && swap_edges(mesh, opts, stats)) {
+      if (!post_rebuild(mesh, opts, stats, t0)) break;
       continue;
     }
-    if (opts.should_coarsen_slivers && coarsen_slivers(mesh, opts)) {
-      post_rebuild(mesh, opts);
+    if (opts.should_coarsen_slivers && coarsen_slivers(mesh, opts, stats)) {
+      if (!post_rebuild(mesh, opts, stats, t0)) break;
       continue;
     }
-    if (opts.should_move_for_quality && move_verts_for_quality(mesh, opts)) {
-      post_rebuild(mesh, opts);
+    if (opts.should_move_for_quality &&
+        move_verts_for_quality(mesh, opts, stats)) {
+      if (!post_rebuild(mesh, opts, stats, t0)) break;
       continue;
     }
     if ((opts.verbosity > SILENT) && !mesh->comm()->rank()) {
@@ -194,11 +277,16 @@ static void satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
     }
     break;
   } while (min_fixable_quality(mesh, opts) < opts.min_quality_desired);
+  stats->quality_time += now() - t1;
 }
 
-static void snap_and_satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
+static void snap_and_satisfy_quality(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats, Now t0) {
 #ifdef OMEGA_H_USE_EGADS
   if (opts.egads_model) {
+    if (stats->stopped_early) return;
+    auto t1 = now();
+    auto quality_time0 = stats->quality_time;
     mesh->set_parting(OMEGA_H_GHOSTED);
     auto warp = egads_get_snap_warp(mesh, opts.egads_model);
     if (opts.should_smooth_snap) {
@@ -206,10 +294,50 @@ static void snap_and_satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
           solve_laplacian(mesh, warp, mesh->dim(), opts.snap_smooth_tolerance);
     }
     mesh->add_tag(VERT, "warp", mesh->dim(), warp);
-    while (warp_to_limit(mesh, opts)) satisfy_quality(mesh, opts);
+    while (warp_to_limit(mesh, opts)) {
+      if (is_over_budget(mesh, opts, stats, t0)) break;
+      satisfy_quality(mesh, opts, stats, t0);
+    }
+    if (mesh->has_tag(VERT, "warp")) mesh->remove_tag(VERT, "warp");
+    stats->snapping_time +=
+        (now() - t1) - (stats->quality_time - quality_time0);
   } else
 #endif
-    satisfy_quality(mesh, opts);
+    satisfy_quality(mesh, opts, stats, t0);
+}
+
+static void reduce_adapt_stats(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats const& local,
+    AdaptStats* stats) {
+  stats->lengths_time = local.lengths_time;
+  stats->quality_time = local.quality_time;
+  stats->snapping_time = local.snapping_time;
+  stats->conservation_time = local.conservation_time;
+  stats->total_time = local.total_time;
+  stats->nrebuilds = local.nrebuilds;
+  stats->stopped_early = local.stopped_early;
+  stats->nrefined_edges = local.nrefined_edges;
+  stats->ncoarsened_verts = local.ncoarsened_verts;
+  stats->nswapped_edges = local.nswapped_edges;
+  stats->nmoved_verts = local.nmoved_verts;
+  stats->nbytes_migrated = local.nbytes_migrated;
+  stats->nelems_after = mesh->nents_owned(mesh->dim());
+  stats->nverts_after = mesh->nents_owned(VERT);
+  ReduceBatch batch;
+  batch.add(&stats->lengths_time, OMEGA_H_MAX);
+  batch.add(&stats->quality_time, OMEGA_H_MAX);
+  batch.add(&stats->snapping_time, OMEGA_H_MAX);
+  batch.add(&stats->conservation_time, OMEGA_H_MAX);
+  batch.add(&stats->total_time, OMEGA_H_MAX);
+  batch.add(&stats->nrefined_edges, OMEGA_H_SUM);
+  batch.add(&stats->ncoarsened_verts, OMEGA_H_SUM);
+  batch.add(&stats->nswapped_edges, OMEGA_H_SUM);
+  batch.add(&stats->nmoved_verts, OMEGA_H_SUM);
+  batch.add(&stats->nbytes_migrated, OMEGA_H_SUM);
+  batch.add(&stats->nelems_after, OMEGA_H_SUM);
+  batch.add(&stats->nverts_after, OMEGA_H_SUM);
+  add_goal_extrema(mesh, opts, &batch, &stats->quality, &stats->length);
+  batch.allreduce(mesh->comm());
 }
 
 static void post_adapt(
@@ -241,19 +369,44 @@ static void post_adapt(
   }
 }
 
-bool adapt(Mesh* mesh, AdaptOpts const& opts) {
+bool adapt(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto t0 = now();
-  if (!pre_adapt(mesh, opts)) return false;
+  AdaptStats local;
+  auto nbytes0 = mesh->library()->migrated_bytes();
+  if (stats) {
+    *stats = AdaptStats();
+    stats->nelems_before = mesh->nglobal_ents(mesh->dim());
+    stats->nverts_before = mesh->nglobal_ents(VERT);
+  }
+  if (opts.should_store_log_metric && !mesh->has_tag(VERT, "log_metric")) {
+    add_log_metric_tag(mesh);
+  }
+  auto should_cache = opts.should_cache_mident_metrics &&
+                      !mesh->has_tag(EDGE, "mident_metric");
+  if (should_cache) add_mident_metric_tag(mesh);
+  if (!pre_adapt(mesh, opts)) {
+    if (should_cache) mesh->remove_tag(EDGE, "mident_metric");
+    local.total_time = now() - t0;
+    local.nbytes_migrated = mesh->library()->migrated_bytes() - nbytes0;
+    if (stats) reduce_adapt_stats(mesh, opts, local, stats);
+    return false;
+  }
   setup_conservation_tags(mesh, opts);
   auto t1 = now();
-  satisfy_lengths(mesh, opts);
+  satisfy_lengths(mesh, opts, &local, t0);
   auto t2 = now();
-  snap_and_satisfy_quality(mesh, opts);
+  snap_and_satisfy_quality(mesh, opts, &local, t0);
   auto t3 = now();
   correct_integral_errors(mesh, opts);
   auto t4 = now();
   mesh->set_parting(OMEGA_H_ELEM_BASED);
+  if (should_cache) mesh->remove_tag(EDGE, "mident_metric");
   post_adapt(mesh, opts, t0, t1, t2, t3, t4);
+  local.lengths_time = t2 - t1;
+  local.conservation_time = t4 - t3;
+  local.total_time = now() - t0;
+  local.nbytes_migrated = mesh->library()->migrated_bytes() - nbytes0;
+  if (stats) reduce_adapt_stats(mesh, opts, local, stats);
   return true;
 }
 
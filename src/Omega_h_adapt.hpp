@@ -4,6 +4,7 @@
 #include <map>
 
 #include <Omega_h_config.h>
+#include <Omega_h_array_ops.hpp>
 #include <Omega_h_compare.hpp>
 #include <Omega_h_defines.hpp>
 #include <Omega_h_mark.hpp>
@@ -53,19 +54,64 @@ struct AdaptOpts {
 #endif
   Int max_motion_steps;
   Real motion_step_size;
+  /* move interior vertices along the quality gradients of their worst
+     elements instead of stepping towards their neighbors.
+     the first trial step is (motion_step_size) times the shortest
+     adjacent edge, and each later one adapts to the last success. */
+  bool should_move_with_gradient;
   bool should_refine;
+  /* split each element by a 1:2, 1:4 or 1:8 template instead of
+     splitting an independent set of edges. falls back to the latter
+     when fields must be conserved. */
+  bool should_refine_with_templates;
+  /* keep the "log_metric" tag (see add_log_metric_tag) on the mesh,
+     which saves most of the eigendecompositions of metric interpolation */
+  bool should_store_log_metric;
+  /* keep the "mident_metric" edge tag (see add_mident_metric_tag)
+     during adaptation, so refinement does not interpolate the
+     same midpoint metrics several times. it is removed afterwards. */
+  bool should_cache_mident_metrics;
   bool should_coarsen;
   bool should_swap;
   bool should_coarsen_slivers;
   bool should_move_for_quality;
   bool should_allow_pinching;
+  /* adapt() stops after the first rebuild that exceeds
+     either of these, leaving a valid mesh behind */
+  Real max_time;
+  Int max_rebuilds;
   TransferOpts xfer_opts;
 };
 
+/* summary of one call to adapt(), already reduced across ranks:
+   times are the maximum over ranks, counts are global sums */
+struct AdaptStats {
+  AdaptStats();  // zeroes everything
+  Real lengths_time;
+  Real quality_time;
+  Real snapping_time;
+  Real conservation_time;
+  Real total_time;
+  Int nrebuilds;
+  bool stopped_early;  // max_time or max_rebuilds was reached
+  GO nrefined_edges;
+  GO ncoarsened_verts;
+  GO nswapped_edges;
+  GO nmoved_verts;
+  GO nelems_before;
+  GO nelems_after;
+  GO nverts_before;
+  GO nverts_after;
+  GO nbytes_migrated;
+  MinMax<Real> quality;
+  MinMax<Real> length;
+};
+
 Real min_fixable_quality(Mesh* mesh, AdaptOpts const& opts);
 
-/* returns false if the mesh was not modified. */
-bool adapt(Mesh* mesh, AdaptOpts const& opts);
+/* returns false if the mesh was not modified.
+   if (stats) is given, it is filled in on all ranks */
+bool adapt(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats = nullptr);
 
 bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts);
 void print_adapt_histograms(Mesh* mesh, AdaptOpts const& opts);
@@ -103,10 +149,18 @@ struct MetricInput {
   Real max_element_count;
   Real min_element_count;
   Real element_count_over_relaxation;
+  /* solve for the element count scalar on a model of the limited
+     field instead of regenerating the field until it is in range.
+     gradation limiting runs at most twice, and the second field
+     is kept even if it is still out of range */
+  bool should_scale_element_count_in_closed_form;
   Int nsmoothing_steps;
 };
 
-Reals generate_metrics(Mesh* mesh, MetricInput const& input);
+/* if (npasses) is given, it receives the number of times the field
+   was composed (and limited, if requested) */
+Reals generate_metrics(
+    Mesh* mesh, MetricInput const& input, Int* npasses = nullptr);
 void add_metric_tag(
     Mesh* mesh, Reals metrics, std::string const& name = "metric");
 void generate_metric_tag(Mesh* mesh, MetricInput const& input);
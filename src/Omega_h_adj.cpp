@@ -153,32 +153,12 @@ LOs form_uses(LOs hv2v, Int high_dim, Int low_dim) {
   return uv2v;
 }
 
-static void sort_by_high_index(LOs l2lh, Write<LO> lh2h, Write<I8> codes) {
-  LO nl = l2lh.size() - 1;
-  auto f = OMEGA_H_LAMBDA(LO l) {
-    LO begin = l2lh[l];
-    LO end = l2lh[l + 1];
-    for (LO j = begin; j < end; ++j) {
-      LO k_min = j;
-      GO min_h = lh2h[j];
-      for (LO k = j + 1; k < end; ++k) {
-        GO h = lh2h[k];
-        if (h < min_h) {
-          k_min = k;
-          min_h = h;
-        }
-      }
-      swap2(lh2h[j], lh2h[k_min]);
-      swap2(codes[j], codes[k_min]);
-    }
-  };
-  parallel_for(nl, f, "sort_by_high_index");
-}
-
 Adj invert_adj(Adj down, Int nlows_per_high, LO nlows) {
   begin_code("invert_adj");
   auto t0 = now();
-  auto l2hl = invert_map_by_atomics(down.ab2b, nlows);
+  /* each (l) lists its uses in increasing (hl),
+     and so in increasing (h) */
+  auto l2hl = invert_map_by_counting(down.ab2b, nlows);
   auto l2lh = l2hl.a2ab;
   auto lh2hl = l2hl.ab2b;
   LO nlh = lh2hl.size();
@@ -207,7 +187,6 @@ Adj invert_adj(Adj down, Int nlows_per_high, LO nlows) {
     };
     parallel_for(nlh, f, "easy_codes");
   }
-  sort_by_high_index(l2lh, lh2h, codes);
   auto t1 = now();
   add_to_global_timer("inverting", t1 - t0);
   end_code();
@@ -1,7 +1,12 @@
 #include "Omega_h_adapt.hpp"
 
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_confined.hpp"
+#include "Omega_h_loop.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mesh.hpp"
 #include "Omega_h_metric.hpp"
+#include "Omega_h_quality.hpp"
 #include "Omega_h_shape.hpp"
 
 namespace Omega_h {
@@ -25,6 +30,134 @@ static bool okay(Mesh* mesh, AdaptOpts const& opts) {
   return minq >= opts.min_quality_allowed && maxl <= opts.max_length_allowed;
 }
 
+/* both warp_to_limit() and approach_metric() used to halve their step
+   and re-evaluate okay() on the whole mesh until it passed.
+   instead, each element and edge scans the candidate steps
+   2^{-k} for k = 1, 2, ... locally and reports the first one
+   it passes, then a single reduction gives the largest step all of
+   them pass.
+   okay() is still evaluated on that step, and halving resumes from
+   there in the unlikely case an entity passes a step and then
+   fails a smaller one, so the result is exactly that of the
+   original bisection. */
+
+OMEGA_H_INLINE Real halved(Int k) {
+  Real t = 1.0;
+  for (Int i = 0; i < k; ++i) t /= 2.0;
+  return t;
+}
+
+template <Int dim, Int metric_dim>
+struct WarpSteps {
+  Reals coords;
+  Reals warp;
+  Reals metrics;
+  OMEGA_H_DEVICE Vector<dim> point(LO v, Int k) const {
+    return get_vector<dim>(coords, v) + get_vector<dim>(warp, v) * halved(k);
+  }
+  OMEGA_H_DEVICE Matrix<metric_dim, metric_dim> metric(LO v, Int) const {
+    return get_symm<metric_dim>(metrics, v);
+  }
+};
+
+template <Int dim, Int metric_dim>
+struct MetricSteps {
+  Reals coords;
+  Reals log_orig;
+  Reals log_target;
+  OMEGA_H_DEVICE Vector<dim> point(LO v, Int) const {
+    return get_vector<dim>(coords, v);
+  }
+  OMEGA_H_DEVICE Matrix<metric_dim, metric_dim> metric(LO v, Int k) const {
+    auto t = halved(k);
+    auto a = get_symm<metric_dim>(log_orig, v);
+    auto b = get_symm<metric_dim>(log_target, v);
+    auto m = delinearize_metric(a * (1.0 - t) + b * t);
+    /* round-trip through storage as delinearize_metrics() does */
+    return vector2symm(symm2vector(m));
+  }
+};
+
+template <Int dim, Int metric_dim, typename Steps>
+static Int find_first_okay_step_tmpl(
+    Mesh* mesh, AdaptOpts const& opts, Steps steps, Int max_k) {
+  auto elems2verts = mesh->ask_elem_verts();
+  auto edges2verts = mesh->ask_verts_of(EDGE);
+  auto elems_are_checked = Read<I8>(mesh->nelems(), 1);
+  if (opts.should_allow_pinching) {
+    elems_are_checked = invert_marks(find_angle_elems(mesh));
+  }
+  auto min_qual = opts.min_quality_allowed;
+  auto max_length = opts.max_length_allowed;
+  Write<I32> elem_ks(mesh->nelems());
+  auto f = OMEGA_H_LAMBDA(LO elem) {
+    Int k = 1;
+    if (elems_are_checked[elem]) {
+      for (; k <= max_k; ++k) {
+        Few<Vector<dim>, dim + 1> p;
+        Few<Matrix<metric_dim, metric_dim>, dim + 1> ms;
+        for (Int ev = 0; ev <= dim; ++ev) {
+          auto v = elems2verts[elem * (dim + 1) + ev];
+          p[ev] = steps.point(v, k);
+          ms[ev] = steps.metric(v, k);
+        }
+        if (metric_element_quality(p, maxdet_metric(ms)) >= min_qual) break;
+      }
+    }
+    elem_ks[elem] = k;
+  };
+  parallel_for(mesh->nelems(), f, "find_first_okay_step(elems)");
+  Write<I32> edge_ks(mesh->nedges());
+  auto g = OMEGA_H_LAMBDA(LO edge) {
+    Int k = 1;
+    for (; k <= max_k; ++k) {
+      Few<Vector<dim>, 2> p;
+      Few<Matrix<metric_dim, metric_dim>, 2> ms;
+      for (Int ev = 0; ev < 2; ++ev) {
+        auto v = edges2verts[edge * 2 + ev];
+        p[ev] = steps.point(v, k);
+        ms[ev] = steps.metric(v, k);
+      }
+      if (metric_edge_length<dim, metric_dim>(p, ms) <= max_length) break;
+    }
+    edge_ks[edge] = k;
+  };
+  parallel_for(mesh->nedges(), g, "find_first_okay_step(edges)");
+  auto comm = mesh->comm();
+  return max2(get_max(comm, Read<I32>(elem_ks)),
+      get_max(comm, Read<I32>(edge_ks)));
+}
+
+template <template <Int, Int> class Steps>
+static Int find_first_okay_step(Mesh* mesh, AdaptOpts const& opts,
+    Reals a, Reals b, Int max_k) {
+  auto dim = mesh->dim();
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  auto metric_dim = get_metrics_dim(mesh->nverts(), metrics);
+  auto coords = mesh->coords();
+  if (dim == 3 && metric_dim == 3) {
+    return find_first_okay_step_tmpl<3, 3>(
+        mesh, opts, Steps<3, 3>{coords, a, b}, max_k);
+  }
+  if (dim == 2 && metric_dim == 2) {
+    return find_first_okay_step_tmpl<2, 2>(
+        mesh, opts, Steps<2, 2>{coords, a, b}, max_k);
+  }
+  if (dim == 3 && metric_dim == 1) {
+    return find_first_okay_step_tmpl<3, 1>(
+        mesh, opts, Steps<3, 1>{coords, a, b}, max_k);
+  }
+  if (dim == 2 && metric_dim == 1) {
+    return find_first_okay_step_tmpl<2, 1>(
+        mesh, opts, Steps<2, 1>{coords, a, b}, max_k);
+  }
+  if (dim == 1) {
+    return find_first_okay_step_tmpl<1, 1>(
+        mesh, opts, Steps<1, 1>{coords, a, b}, max_k);
+  }
+  OMEGA_H_NORETURN(-1);
+}
+
 bool warp_to_limit(Mesh* mesh, AdaptOpts const& opts) {
   if (!mesh->has_tag(VERT, "warp")) return false;
   check_okay(mesh, opts);
@@ -35,11 +168,17 @@ bool warp_to_limit(Mesh* mesh, AdaptOpts const& opts) {
     mesh->remove_tag(VERT, "warp");
     return true;
   }
-  auto remainder = Reals(warp.size(), 0.0);
-  Int i = 0;
   constexpr Int max_i = 40;
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  mesh->set_coords(coords);
+  auto i =
+      find_first_okay_step<WarpSteps>(mesh, opts, warp, metrics, max_i - 1);
+  auto remainder = Reals(warp.size(), 0.0);
+  for (Int j = 1; j < i; ++j) {
+    warp = multiply_each_by(1.0 / 2.0, warp);
+    remainder = add_each(remainder, warp);
+  }
   do {
-    ++i;
     if (i == max_i) {
       Omega_h_fail(
           "warp step %d : Omega_h is probably unable to satisfy"
@@ -51,6 +190,7 @@ bool warp_to_limit(Mesh* mesh, AdaptOpts const& opts) {
     warp = half_warp;
     remainder = add_each(remainder, half_warp);
     mesh->set_coords(add_each(coords, warp));
+    ++i;
   } while (!okay(mesh, opts));
   mesh->set_tag(VERT, "warp", remainder);
   return true;
@@ -63,13 +203,27 @@ bool approach_metric(Mesh* mesh, AdaptOpts const& opts) {
   check_okay(mesh, opts);
   auto orig = mesh->get_array<Real>(VERT, name);
   auto target = mesh->get_array<Real>(VERT, target_name);
+  auto nverts = mesh->nverts();
+  /* setting the metric removes "log_metric", which is restored
+     from the interpolated logarithms at the end */
+  auto has_log = mesh->has_tag(VERT, "log_metric");
+  auto log_orig = has_log ? mesh->get_array<Real>(VERT, "log_metric")
+                          : linearize_metrics(nverts, orig);
   mesh->set_tag(VERT, name, target);
   if (okay(mesh, opts)) {
     mesh->remove_tag(VERT, target_name);
+    if (has_log) add_log_metric_tag(mesh);
     return true;
   }
-  Real t = 1.0;
   constexpr Real min_t = 1e-4;
+  Int max_k = 0;
+  while (halved(max_k + 1) >= min_t) ++max_k;
+  auto log_target = linearize_metrics(nverts, target);
+  mesh->set_tag(VERT, name, orig);
+  auto k = find_first_okay_step<MetricSteps>(
+      mesh, opts, log_orig, log_target, max_k);
+  Real t = halved(k - 1);
+  Reals log_current;
   do {
     t /= 2.0;
     if (t < min_t) {
@@ -78,9 +232,14 @@ bool approach_metric(Mesh* mesh, AdaptOpts const& opts) {
           "Omega_h is probably unable to satisfy this size field\n",
           t, min_t);
     }
-    auto current = interpolate_between_metrics(mesh->nverts(), orig, target, t);
+    log_current = interpolate_between(log_orig, log_target, t);
+    auto current = delinearize_metrics(nverts, log_current);
     mesh->set_tag(VERT, name, current);
   } while (!okay(mesh, opts));
+  if (has_log) {
+    auto ncomps = mesh->get_tagbase(VERT, name)->ncomps();
+    mesh->add_tag(VERT, "log_metric", ncomps, log_current, true);
+  }
   return true;
 }
 
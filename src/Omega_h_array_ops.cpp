@@ -1,5 +1,6 @@
 #include "Omega_h_array_ops.hpp"
 
+#include "Omega_h_few.hpp"
 #include "Omega_h_loop.hpp"
 
 namespace Omega_h {
@@ -84,7 +85,12 @@ T get_max(CommPtr comm, Read<T> a) {
 
 template <typename T>
 MinMax<T> get_minmax(CommPtr comm, Read<T> a) {
-  return {get_min(comm, a), get_max(comm, a)};
+  MinMax<T> r = {get_min(a), get_max(a)};
+  ReduceBatch batch;
+  batch.add(&r.min, OMEGA_H_MIN);
+  batch.add(&r.max, OMEGA_H_MAX);
+  batch.allreduce(comm);
+  return r;
 }
 
 struct AreClose : public AndFunctor {
@@ -477,7 +483,7 @@ Read<T> interleave(std::vector<Read<T>> arrays) {
    which has 52 bits in the fraction.
 
    The idea here is to add the numbers as fixed-point values.
-   max_exponent() finds the largest exponent (e) such that
+   We find the largest exponent (e) such that
    all values are (<= 2^(e)).
    We then use the value (2^(e - 52)) as the unit, and sum all
    values as integers in that unit.
@@ -494,47 +500,121 @@ Read<T> interleave(std::vector<Read<T>> arrays) {
    support a maximum of one million MPI ranks (10^6)
    and each rank typically can't hold more than
    one billion values (10^9), for a total of (10^15) values.
+
+   All components of a multi-component array are handled
+   together: one pass finds their magnitudes, one reduction
+   agrees on them across ranks, one pass accumulates their
+   fixed-point sums and one reduction adds those up.
 */
 
-struct MaxExponent : public MaxFunctor<int> {
+/* the exponent of frexp() grows with the magnitude,
+   so the largest exponent is that of the largest magnitude.
+   frexp(0.0) gives the exponent 0, as does 0.5, so zeros count
+   as 0.5 to take part in the unit exactly as they always have */
+template <Int n>
+struct MaxMagnitudes {
+  typedef Few<Real, n> value_type;
   Reals a_;
-  MaxExponent(Reals a) : a_(a) {}
-  OMEGA_H_DEVICE void operator()(Int i, value_type& update) const {
-    int expo;
-    frexp(a_[i], &expo);
-    if (expo > update) update = expo;
+  MaxMagnitudes(Reals a) : a_(a) {}
+  OMEGA_H_INLINE void init(value_type& update) const {
+    for (Int c = 0; c < n; ++c) update[c] = 0.0;
+  }
+  OMEGA_H_INLINE void join(
+      volatile value_type& update, const volatile value_type& input) const {
+    for (Int c = 0; c < n; ++c) update[c] = max2<Real>(update[c], input[c]);
+  }
+  OMEGA_H_DEVICE void operator()(LO i, value_type& update) const {
+    for (Int c = 0; c < n; ++c) {
+      auto x = fabs(a_[i * n + c]);
+      update[c] = max2(update[c], (x == 0.0) ? 0.5 : x);
+    }
   }
 };
 
-static int max_exponent(Reals a) {
-  return static_cast<int>(parallel_reduce(a.size(), MaxExponent(a)));
-}
-
-struct ReproSum : public SumFunctor<Int128> {
+/* dividing by a power of two and multiplying by its inverse round
+   the same exact value, so when the inverse is a double the
+   cheaper multiplication gives the same bits as from_double() */
+template <Int n>
+struct ReproSums {
+  typedef Few<Int128, n> value_type;
   Reals a_;
-  double unit_;
-  ReproSum(Reals a, double unit) : a_(a), unit_(unit) {}
-  OMEGA_H_DEVICE void operator()(Int i, value_type& update) const {
-    update = update + Int128::from_double(a_[i], unit_);
+  Few<double, n> units_;
+  Few<double, n> inverses_;  // zero if not representable
+  ReproSums(Reals a, Few<double, n> units) : a_(a), units_(units) {
+    for (Int c = 0; c < n; ++c) {
+      auto inverse = 1.0 / units[c];
+      inverses_[c] = (inverse * units[c] == 1.0) ? inverse : 0.0;
+    }
+  }
+  OMEGA_H_INLINE void init(value_type& update) const {
+    for (Int c = 0; c < n; ++c) update[c] = Int128(0);
+  }
+  OMEGA_H_INLINE void join(
+      volatile value_type& update, const volatile value_type& input) const {
+    for (Int c = 0; c < n; ++c) {
+      update[c] = Int128(update[c]) + Int128(input[c]);
+    }
+  }
+  OMEGA_H_DEVICE void operator()(LO i, value_type& update) const {
+    for (Int c = 0; c < n; ++c) {
+      auto x = a_[i * n + c];
+      auto fixpt = (inverses_[c] != 0.0)
+                       ? Int128(std::int64_t(x * inverses_[c]))
+                       : Int128::from_double(x, units_[c]);
+      update[c] = update[c] + fixpt;
+    }
   }
 };
 
+/* (comm) is null for a sum over this rank alone */
+template <Int n>
+static void repro_sum_tmpl(CommPtr comm, Reals a, Real result[]) {
+  auto nitems = divide_no_remainder(a.size(), n);
+  auto maxes = parallel_reduce(nitems, MaxMagnitudes<n>(a), "repro_sum");
+  if (comm) {
+    ReduceBatch batch;
+    for (Int c = 0; c < n; ++c) batch.add(&maxes[c], OMEGA_H_MAX);
+    batch.allreduce(comm);
+  }
+  Few<double, n> units;
+  for (Int c = 0; c < n; ++c) {
+    int expo;
+    frexp(maxes[c], &expo);
+    units[c] = exp2(double(expo - MANTISSA_BITS));
+  }
+  auto fixpt_sums =
+      parallel_reduce(nitems, ReproSums<n>(a, units), "repro_sum");
+  if (comm) comm->add_int128(&fixpt_sums[0], n);
+  for (Int c = 0; c < n; ++c) result[c] = fixpt_sums[c].to_double(units[c]);
+}
+
 Real repro_sum(Reals a) {
-  int expo = max_exponent(a);
-  double unit = exp2(double(expo - MANTISSA_BITS));
-  Int128 fixpt_sum = parallel_reduce(a.size(), ReproSum(a, unit));
-  return fixpt_sum.to_double(unit);
+  Real result;
+  repro_sum_tmpl<1>(CommPtr(), a, &result);
+  return result;
 }
 
 Real repro_sum(CommPtr comm, Reals a) {
-  int expo = comm->allreduce(max_exponent(a), OMEGA_H_MAX);
-  double unit = exp2(double(expo - MANTISSA_BITS));
-  Int128 fixpt_sum = parallel_reduce(a.size(), ReproSum(a, unit));
-  fixpt_sum = comm->add_int128(fixpt_sum);
-  return fixpt_sum.to_double(unit);
+  Real result;
+  repro_sum_tmpl<1>(comm, a, &result);
+  return result;
 }
 
 void repro_sum(CommPtr comm, Reals a, Int ncomps, Real result[]) {
+  switch (ncomps) {
+    case 1:
+      repro_sum_tmpl<1>(comm, a, result);
+      return;
+    case 2:
+      repro_sum_tmpl<2>(comm, a, result);
+      return;
+    case 3:
+      repro_sum_tmpl<3>(comm, a, result);
+      return;
+    case 6:
+      repro_sum_tmpl<6>(comm, a, result);
+      return;
+  }
   for (Int comp = 0; comp < ncomps; ++comp) {
     result[comp] = repro_sum(comm, get_component(a, ncomps, comp));
   }
@@ -35,6 +35,22 @@ OMEGA_H_INLINE BBox<dim> unite(BBox<dim> a, BBox<dim> b) {
   return c;
 }
 
+template <Int dim, Int n>
+OMEGA_H_INLINE BBox<dim> bounding_box(Few<Vector<dim>, n> points) {
+  BBox<dim> c(points[0]);
+  for (Int i = 1; i < n; ++i) c = unite(c, BBox<dim>(points[i]));
+  return c;
+}
+
+/* false only if the boxes are separated along some axis */
+template <Int dim>
+OMEGA_H_INLINE bool intersect(BBox<dim> a, BBox<dim> b) {
+  for (Int i = 0; i < dim; ++i) {
+    if (a.max[i] < b.min[i] || b.max[i] < a.min[i]) return false;
+  }
+  return true;
+}
+
 template <Int dim>
 OMEGA_H_INLINE bool are_close(BBox<dim> a, BBox<dim> b) {
   return are_close(a.min, b.min) && are_close(a.max, b.max);
@@ -5,6 +5,7 @@
 namespace Omega_h {
 
 void bcast_mesh(Mesh* mesh, CommPtr new_comm, bool is_source) {
+  begin_code("bcast_mesh");
   if (new_comm->rank() == 0) {
     OMEGA_H_CHECK(is_source);
   }
@@ -56,6 +57,7 @@ void bcast_mesh(Mesh* mesh, CommPtr new_comm, bool is_source) {
       }
     }
   }
+  end_code();
 }
 
 }  // end namespace Omega_h
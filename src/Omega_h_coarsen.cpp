@@ -95,7 +95,8 @@ static bool coarsen_ghosted(Mesh* mesh, AdaptOpts const& opts,
   return true;
 }
 
-static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
+static void coarsen_element_based2(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto verts_are_keys = mesh->get_array<I8>(VERT, "key");
   auto vert_quals = mesh->get_array<Real>(VERT, "collapse_quality");
@@ -103,6 +104,7 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
   mesh->remove_tag(VERT, "collapse_rail");
   auto keys2verts = collect_marked(verts_are_keys);
   auto nkeys = keys2verts.size();
+  if (stats) stats->ncoarsened_verts += nkeys;
   if (opts.verbosity >= EACH_REBUILD) {
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
     if (comm->rank() == 0) {
@@ -146,19 +148,20 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
 }
 
 static bool coarsen(Mesh* mesh, AdaptOpts const& opts, OvershootLimit overshoot,
-    Improve improve) {
+    Improve improve, AdaptStats* stats) {
   if (!coarsen_element_based1(mesh)) return false;
   mesh->set_parting(OMEGA_H_GHOSTED);
   if (!coarsen_ghosted(mesh, opts, overshoot, improve)) {
     return false;
   }
   mesh->set_parting(OMEGA_H_ELEM_BASED, false);
-  coarsen_element_based2(mesh, opts);
+  coarsen_element_based2(mesh, opts, stats);
   return true;
 }
 
 static bool coarsen_verts(Mesh* mesh, AdaptOpts const& opts,
-    Read<I8> vert_marks, OvershootLimit overshoot, Improve improve) {
+    Read<I8> vert_marks, OvershootLimit overshoot, Improve improve,
+    AdaptStats* stats) {
   auto ev2v = mesh->ask_verts_of(EDGE);
   Write<I8> edge_codes_w(mesh->nedges(), DONT_COLLAPSE);
   auto f = OMEGA_H_LAMBDA(LO e) {
@@ -172,31 +175,33 @@ static bool coarsen_verts(Mesh* mesh, AdaptOpts const& opts,
   };
   parallel_for(mesh->nedges(), f, "coarsen_verts(edge_codes)");
   mesh->add_tag(EDGE, "collapse_code", 1, Read<I8>(edge_codes_w));
-  return coarsen(mesh, opts, overshoot, improve);
+  return coarsen(mesh, opts, overshoot, improve, stats);
 }
 
 static bool coarsen_ents(Mesh* mesh, AdaptOpts const& opts, Int ent_dim,
-    Read<I8> marks, OvershootLimit overshoot, Improve improve) {
+    Read<I8> marks, OvershootLimit overshoot, Improve improve,
+    AdaptStats* stats) {
   auto vert_marks = mark_down(mesh, ent_dim, VERT, marks);
-  return coarsen_verts(mesh, opts, vert_marks, overshoot, improve);
+  return coarsen_verts(mesh, opts, vert_marks, overshoot, improve, stats);
 }
 
-bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts) {
+bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto lengths = mesh->ask_lengths();
   auto edge_is_cand = each_lt(lengths, opts.min_length_desired);
   if (get_max(comm, edge_is_cand) != 1) return false;
-  return coarsen_ents(mesh, opts, EDGE, edge_is_cand, DESIRED, DONT_IMPROVE);
+  return coarsen_ents(
+      mesh, opts, EDGE, edge_is_cand, DESIRED, DONT_IMPROVE, stats);
 }
 
-bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts) {
+bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   mesh->set_parting(OMEGA_H_GHOSTED);
   auto comm = mesh->comm();
   auto elems_are_cands =
       mark_sliver_layers(mesh, opts.min_quality_desired, opts.nsliver_layers);
   OMEGA_H_CHECK(get_max(comm, elems_are_cands) == 1);
-  return coarsen_ents(
-      mesh, opts, mesh->dim(), elems_are_cands, ALLOWED, IMPROVE_LOCALLY);
+  return coarsen_ents(mesh, opts, mesh->dim(), elems_are_cands, ALLOWED,
+      IMPROVE_LOCALLY, stats);
 }
 
 }  // end namespace Omega_h
@@ -37,9 +37,11 @@ LOs get_verts_onto(Mesh* mesh, LOs rails2edges, Read<I8> rail_col_dirs);
 LOs coarsen_topology(Mesh* mesh, LOs keys2verts_onto, Int dom_dim,
     Adj keys2doms, LOs old_verts2new_verts);
 
-bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts);
+bool coarsen_by_size(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats = nullptr);
 
-bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts);
+bool coarsen_slivers(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats = nullptr);
 
 }  // end namespace Omega_h
 
@@ -9,50 +9,71 @@
 
 namespace Omega_h {
 
+/* the cavity of collapsing edge (key / 2) away from its
+   vertex (key % 2): every element around the collapsing vertex
+   that does not contain the other one, with the collapsing
+   vertex replaced by the other one */
+template <Int mesh_dim, Int metric_dim>
+struct CoarsenCavities {
+  MetricElementQualities<mesh_dim, metric_dim> measure;
+  LOs cands2edges;
+  Read<I8> cand_codes;
+  LOs ev2v;
+  LOs cv2v;
+  LOs v2vc;
+  LOs vc2c;
+  Read<I8> vc_codes;
+  CoarsenCavities(Mesh* mesh, LOs cands2edges_, Read<I8> cand_codes_)
+      : measure(mesh),
+        cands2edges(cands2edges_),
+        cand_codes(cand_codes_),
+        ev2v(mesh->ask_verts_of(EDGE)),
+        cv2v(mesh->ask_elem_verts()) {
+    auto v2c = mesh->ask_up(VERT, mesh_dim);
+    v2vc = v2c.a2ab;
+    vc2c = v2c.ab2b;
+    vc_codes = v2c.codes;
+  }
+  OMEGA_H_DEVICE Int count(LO key) const {
+    auto cand = key / 2;
+    auto eev_col = key % 2;
+    if (!collapses(cand_codes[cand], eev_col)) return -1;
+    auto v_col = ev2v[cands2edges[cand] * 2 + eev_col];
+    return v2vc[v_col + 1] - v2vc[v_col];
+  }
+  OMEGA_H_DEVICE bool get(LO key, Int i,
+      Few<Vector<mesh_dim>, mesh_dim + 1>* p,
+      Few<Matrix<metric_dim, metric_dim>, mesh_dim + 1>* ms) const {
+    auto e = cands2edges[key / 2];
+    auto eev_col = key % 2;
+    auto v_col = ev2v[e * 2 + eev_col];
+    auto v_onto = ev2v[e * 2 + (1 - eev_col)];
+    auto vc = v2vc[v_col] + i;
+    auto c = vc2c[vc];
+    auto ccv_col = code_which_down(vc_codes[vc]);
+    auto ccv2v = gather_verts<mesh_dim + 1>(cv2v, c);
+    for (auto ccv = 0; ccv < (mesh_dim + 1); ++ccv) {
+      if ((ccv != ccv_col) && (ccv2v[ccv] == v_onto)) return false;
+    }
+    OMEGA_H_CHECK(0 <= ccv_col && ccv_col < mesh_dim + 1);
+    ccv2v[ccv_col] = v_onto;  // vertices of new cell
+    measure.gather(ccv2v, p, ms);
+    return true;
+  }
+};
+
 template <Int mesh_dim, Int metric_dim>
 static Reals coarsen_qualities_tmpl(
     Mesh* mesh, LOs cands2edges, Read<I8> cand_codes) {
   OMEGA_H_CHECK(mesh->dim() == mesh_dim);
-  MetricElementQualities<mesh_dim, metric_dim> measure(mesh);
-  auto ev2v = mesh->ask_verts_of(EDGE);
-  auto cv2v = mesh->ask_elem_verts();
-  auto v2c = mesh->ask_up(VERT, mesh_dim);
-  auto v2vc = v2c.a2ab;
-  auto vc2c = v2c.ab2b;
-  auto vc_codes = v2c.codes;
-  auto ncands = cands2edges.size();
-  auto qualities = Write<Real>(ncands * 2, -1.0);
-  auto f = OMEGA_H_LAMBDA(LO cand) {
-    auto e = cands2edges[cand];
-    auto code = cand_codes[cand];
-    for (Int eev_col = 0; eev_col < 2; ++eev_col) {
-      if (!collapses(code, eev_col)) continue;
-      auto v_col = ev2v[e * 2 + eev_col];
-      auto eev_onto = 1 - eev_col;
-      auto v_onto = ev2v[e * 2 + eev_onto];
-      Real minqual = 1.0;
-      for (auto vc = v2vc[v_col]; vc < v2vc[v_col + 1]; ++vc) {
-        auto c = vc2c[vc];
-        auto vc_code = vc_codes[vc];
-        auto ccv_col = code_which_down(vc_code);
-        auto ccv2v = gather_verts<mesh_dim + 1>(cv2v, c);
-        bool will_die = false;
-        for (auto ccv = 0; ccv < (mesh_dim + 1); ++ccv) {
-          if ((ccv != ccv_col) && (ccv2v[ccv] == v_onto)) {
-            will_die = true;
-            break;
-          }
-        }
-        if (will_die) continue;
-        OMEGA_H_CHECK(0 <= ccv_col && ccv_col < mesh_dim + 1);
-        ccv2v[ccv_col] = v_onto;  // vertices of new cell
-        auto qual = measure.measure(ccv2v);
-        minqual = min2(minqual, qual);
-      }
-      qualities[cand * 2 + eev_col] = minqual;
-    }
+  auto cavities =
+      CoarsenCavities<mesh_dim, metric_dim>(mesh, cands2edges, cand_codes);
+  auto nkeys = cands2edges.size() * 2;
+  auto qualities = Write<Real>(nkeys);
+  auto f = OMEGA_H_LAMBDA(LO key) {
+    qualities[key] = cavity_min_quality<mesh_dim, metric_dim>(cavities, key);
   };
-  parallel_for(ncands, f, "coarsen_qualities");
+  parallel_for(nkeys, f, "coarsen_qualities");
   auto out = Reals(qualities);
   return mesh->sync_subset_array(EDGE, out, cands2edges, -1.0, 2);
 }
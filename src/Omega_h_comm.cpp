@@ -1,29 +1,199 @@
 #include "Omega_h_comm.hpp"
 
 #include <string>
+#ifdef OMEGA_H_USE_MPI
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#endif
+#ifndef OMEGA_H_USE_MPI
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
 
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_control.hpp"
+#include "Omega_h_library.hpp"
 #include "Omega_h_scan.hpp"
+#include "Omega_h_timer.hpp"
 #ifdef OMEGA_H_USE_CUDA
-#include "Omega_h_library.hpp"
 #include "Omega_h_loop.hpp"
 #endif
+#if defined(OMEGA_H_USE_MPI) && defined(OMEGA_H_USE_ZLIB)
+#include <zlib.h>
+#endif
 
 namespace Omega_h {
 
 #ifdef OMEGA_H_USE_MPI
 #define CALL(f) OMEGA_H_CHECK(MPI_SUCCESS == (f))
+#else
+/* the ranks of a communicator made by run_on_threads().
+   in each collective, every rank publishes a pointer to its
+   contribution, waits for the others, reads what it needs straight
+   out of their buffers and then waits again, so that no buffer
+   is released while another rank may still be reading it */
+struct ThreadGroup {
+  I32 size;
+  std::mutex mutex;
+  std::condition_variable cv;
+  I32 narrived;
+  I64 generation;
+  std::vector<void const*> posts;
+  ThreadGroup(I32 size_in)
+      : size(size_in),
+        narrived(0),
+        generation(0),
+        posts(std::size_t(size_in), nullptr) {}
+  void barrier() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto my_generation = generation;
+    if (++narrived == size) {
+      narrived = 0;
+      ++generation;
+      cv.notify_all();
+      return;
+    }
+    cv.wait(lock, [&]() { return generation != my_generation; });
+  }
+  void const* const* publish(I32 rank, void const* contribution) {
+    posts[std::size_t(rank)] = contribution;
+    barrier();
+    return posts.data();
+  }
+};
+
+/* what each rank contributes when communicators are created */
+struct ThreadCommPost {
+  I32 color;
+  I32 key;
+  HostRead<I32> dsts;
+  std::shared_ptr<ThreadGroup> group;
+};
+
+/* what each rank contributes to alltoall() and alltoallv() */
+template <typename T>
+struct ThreadMessages {
+  Read<T> const* sendbuf;
+  T const* data;
+  LO const* sdispls;  // null if there is one item per destination
+  I32 const* dsts;
+  LO ndsts;
+};
+
+template <typename T>
+static LO find_destination(ThreadMessages<T> const& from, I32 rank) {
+  for (LO i = 0; i < from.ndsts; ++i) {
+    if (from.dsts[i] == rank) return i;
+  }
+  OMEGA_H_NORETURN(-1);
+}
+
+/* collectively makes the communicator of dup(), graph() and
+   graph_adjacent(). if (srcs) does not exist but (dsts) does,
+   the sources are the ranks that list this one as a destination,
+   in increasing order */
+static CommPtr new_thread_comm(Library* library, ThreadGroup* old, I32 rank,
+    Read<I32> srcs, Read<I32> dsts) {
+  bool find_srcs = dsts.exists() && !srcs.exists();
+  ThreadCommPost post;
+  if (find_srcs) post.dsts = HostRead<I32>(dsts);
+  if (rank == 0) post.group = std::make_shared<ThreadGroup>(old->size);
+  auto posts = old->publish(rank, &post);
+  auto group = static_cast<ThreadCommPost const*>(posts[0])->group;
+  if (find_srcs) {
+    std::vector<I32> sources;
+    for (I32 r = 0; r < old->size; ++r) {
+      auto& other = static_cast<ThreadCommPost const*>(posts[r])->dsts;
+      for (LO i = 0; i < other.size(); ++i) {
+        if (other[i] == rank) sources.push_back(r);
+      }
+    }
+    HostWrite<I32> host_srcs(LO(sources.size()));
+    for (LO i = 0; i < host_srcs.size(); ++i) host_srcs[i] = sources[i];
+    srcs = host_srcs.write();
+  }
+  old->barrier();
+  return CommPtr(new Comm(library, group, rank, srcs, dsts));
+}
 #endif
 
+template <typename T>
+static T apply_op(Omega_h_Op op, T a, T b) {
+  switch (op) {
+    case OMEGA_H_MIN:
+      return min2(a, b);
+    case OMEGA_H_MAX:
+      return max2(a, b);
+    case OMEGA_H_SUM:
+      return a + b;
+  }
+  OMEGA_H_NORETURN(a);
+}
+
+/* with --osh-time or --osh-comm-json, charges one call to the
+   innermost begin_code region, along with the time until the
+   counter goes out of scope (see Library::add_comm_stats).
+   collectives count as one message of (nbytes) each way */
+class CommCounter {
+ public:
+  CommCounter(Library* library, char const* op, I64 nbytes)
+      : library_(should_count_comm ? library : nullptr), op_(op) {
+    if (!library_) return;
+    stats_.ncalls = 1;
+    stats_.nmessages = 1;
+    stats_.nsent_bytes = stats_.nrecvd_bytes = nbytes;
+    t0_ = now();
+  }
+  ~CommCounter() {
+    if (!library_) return;
+    stats_.time = now() - t0_;
+    library_->add_comm_stats(current_code(), op_, stats_);
+  }
+  bool counts() const { return library_ != nullptr; }
+  void set_exchange(
+      LO nneighbors, LO nmessages, I64 nsent_bytes, I64 nrecvd_bytes) {
+    stats_.nneighbors = nneighbors;
+    stats_.nmessages = nmessages;
+    stats_.nsent_bytes = nsent_bytes;
+    stats_.nrecvd_bytes = nrecvd_bytes;
+  }
+
+ private:
+  Library* library_;
+  char const* op_;
+  CommStats stats_;
+  Now t0_;
+};
+
+static LO count_messages(HostRead<LO> counts) {
+  LO n = 0;
+  for (LO i = 0; i < counts.size(); ++i) n += (counts[i] != 0);
+  return n;
+}
+
 Comm::Comm() {
 #ifdef OMEGA_H_USE_MPI
   impl_ = MPI_COMM_NULL;
+  node_impl_ = MPI_COMM_NULL;
+  leaders_impl_ = MPI_COMM_NULL;
+  uses_nodes_ = 0;
+#else
+  rank_ = 0;
 #endif
   library_ = nullptr;
 }
 
 #ifdef OMEGA_H_USE_MPI
-Comm::Comm(Library* library, MPI_Comm impl) : impl_(impl), library_(library) {
+Comm::Comm(Library* library, MPI_Comm impl)
+    : impl_(impl),
+      node_impl_(MPI_COMM_NULL),
+      leaders_impl_(MPI_COMM_NULL),
+      uses_nodes_(-1),
+      library_(library) {
   int topo_type;
   CALL(MPI_Topo_test(impl, &topo_type));
   if (topo_type == MPI_DIST_GRAPH) {
@@ -44,7 +214,7 @@ Comm::Comm(Library* library, MPI_Comm impl) : impl_(impl), library_(library) {
 }
 #else
 Comm::Comm(Library* library, bool is_graph, bool sends_to_self)
-    : library_(library) {
+    : rank_(0), library_(library) {
   if (is_graph) {
     if (sends_to_self) {
       srcs_ = Read<LO>({0});
@@ -60,10 +230,25 @@ Comm::Comm(Library* library, bool is_graph, bool sends_to_self)
     OMEGA_H_CHECK(!sends_to_self);
   }
 }
+
+Comm::Comm(Library* library, std::shared_ptr<ThreadGroup> group, I32 rank,
+    Read<I32> srcs, Read<I32> dsts)
+    : group_(group), rank_(rank), library_(library) {
+  if (srcs.exists()) {
+    srcs_ = srcs;
+    dsts_ = dsts;
+    self_src_ = find_last(srcs_, rank);
+    self_dst_ = find_last(dsts_, rank);
+    host_srcs_ = HostRead<I32>(srcs_);
+    host_dsts_ = HostRead<I32>(dsts_);
+  }
+}
 #endif
 
 Comm::~Comm() {
 #ifdef OMEGA_H_USE_MPI
+  if (node_impl_ != MPI_COMM_NULL) CALL(MPI_Comm_free(&node_impl_));
+  if (leaders_impl_ != MPI_COMM_NULL) CALL(MPI_Comm_free(&leaders_impl_));
   CALL(MPI_Comm_free(&impl_));
 #endif
 }
@@ -76,7 +261,7 @@ I32 Comm::rank() const {
   CALL(MPI_Comm_rank(impl_, &r));
   return r;
 #else
-  return 0;
+  return group_ ? rank_ : 0;
 #endif
 }
 
@@ -86,7 +271,7 @@ I32 Comm::size() const {
   CALL(MPI_Comm_size(impl_, &s));
   return s;
 #else
-  return 1;
+  return group_ ? group_->size : 1;
 #endif
 }
 
@@ -96,6 +281,9 @@ CommPtr Comm::dup() const {
   CALL(MPI_Comm_dup(impl_, &impl2));
   return CommPtr(new Comm(library_, impl2));
 #else
+  if (group_) {
+    return new_thread_comm(library_, group_.get(), rank_, srcs_, dsts_);
+  }
   return CommPtr(
       new Comm(library_, srcs_.exists(), srcs_.exists() && srcs_.size() == 1));
 #endif
@@ -107,6 +295,31 @@ CommPtr Comm::split(I32 color, I32 key) const {
   CALL(MPI_Comm_split(impl_, color, key, &impl2));
   return CommPtr(new Comm(library_, impl2));
 #else
+  if (group_) {
+    ThreadCommPost post;
+    post.color = color;
+    post.key = key;
+    auto posts = group_->publish(rank_, &post);
+    std::vector<std::pair<I32, I32>> members;  // (key, old rank)
+    for (I32 r = 0; r < group_->size; ++r) {
+      auto other = static_cast<ThreadCommPost const*>(posts[r]);
+      if (other->color == color) members.push_back({other->key, r});
+    }
+    group_->barrier();
+    std::sort(members.begin(), members.end());
+    auto new_rank = I32(
+        std::find(members.begin(), members.end(), std::make_pair(key, rank_)) -
+        members.begin());
+    if (new_rank == 0) {
+      post.group = std::make_shared<ThreadGroup>(I32(members.size()));
+    }
+    posts = group_->publish(rank_, &post);
+    auto group =
+        static_cast<ThreadCommPost const*>(posts[members[0].second])->group;
+    group_->barrier();
+    return CommPtr(
+        new Comm(library_, group, new_rank, Read<I32>(), Read<I32>()));
+  }
   (void)color;
   (void)key;
   return CommPtr(new Comm(library_, false, false));
@@ -126,6 +339,9 @@ CommPtr Comm::graph(Read<I32> dsts) const {
       reorder, &impl2));
   return CommPtr(new Comm(library_, impl2));
 #else
+  if (group_) {
+    return new_thread_comm(library_, group_.get(), rank_, Read<I32>(), dsts);
+  }
   return CommPtr(new Comm(library_, true, dsts.size() == 1));
 #endif
 }
@@ -142,6 +358,9 @@ CommPtr Comm::graph_adjacent(Read<I32> srcs, Read<I32> dsts) const {
       reorder, &impl2));
   return CommPtr(new Comm(library_, impl2));
 #else
+  if (group_) {
+    return new_thread_comm(library_, group_.get(), rank_, srcs, dsts);
+  }
   OMEGA_H_CHECK(srcs == dsts);
   return CommPtr(new Comm(library_, true, dsts.size() == 1));
 #endif
@@ -155,12 +374,80 @@ Read<I32> Comm::sources() const { return srcs_; }
 
 Read<I32> Comm::destinations() const { return dsts_; }
 
+#ifdef OMEGA_H_USE_MPI
+/* decides (collectively, on first use) whether reductions over this
+   communicator go through node leaders. graph communicators and
+   communicators that lie within one node, or have one rank
+   per node, reduce directly */
+bool Comm::uses_nodes() const {
+  if (!library_ || !library_->node_aware() || srcs_.exists()) return false;
+  if (uses_nodes_ >= 0) return uses_nodes_ != 0;
+  uses_nodes_ = 0;
+  auto r = rank();
+  auto ranks_per_node = library_->ranks_per_node();
+  if (ranks_per_node > 0) {
+    CALL(MPI_Comm_split(impl_, r / ranks_per_node, r, &node_impl_));
+  } else {
+#if MPI_VERSION >= 3
+    CALL(MPI_Comm_split_type(
+        impl_, MPI_COMM_TYPE_SHARED, r, MPI_INFO_NULL, &node_impl_));
+#else
+    return false;
+#endif
+  }
+  int node_rank, node_size;
+  CALL(MPI_Comm_rank(node_impl_, &node_rank));
+  CALL(MPI_Comm_size(node_impl_, &node_size));
+  int color = (node_rank == 0) ? 0 : MPI_UNDEFINED;
+  CALL(MPI_Comm_split(impl_, color, r, &leaders_impl_));
+  int max_node_size = node_size;
+  CALL(MPI_Allreduce(
+      MPI_IN_PLACE, &max_node_size, 1, MPI_INT, MPI_MAX, impl_));
+  if (max_node_size == 1 || max_node_size == size()) {
+    CALL(MPI_Comm_free(&node_impl_));
+    if (leaders_impl_ != MPI_COMM_NULL) CALL(MPI_Comm_free(&leaders_impl_));
+    return false;
+  }
+  uses_nodes_ = 1;
+  return true;
+}
+
+/* in node-aware mode, reduces within each node onto its leader,
+   among the leaders, and then broadcasts within each node */
+void Comm::allreduce_in_place(
+    void* data, int count, MPI_Datatype type, MPI_Op op) const {
+  if (!uses_nodes()) {
+    CALL(MPI_Allreduce(MPI_IN_PLACE, data, count, type, op, impl_));
+    return;
+  }
+  int node_rank;
+  CALL(MPI_Comm_rank(node_impl_, &node_rank));
+  if (node_rank == 0) {
+    CALL(MPI_Reduce(MPI_IN_PLACE, data, count, type, op, 0, node_impl_));
+    CALL(MPI_Allreduce(MPI_IN_PLACE, data, count, type, op, leaders_impl_));
+  } else {
+    CALL(MPI_Reduce(data, nullptr, count, type, op, 0, node_impl_));
+  }
+  CALL(MPI_Bcast(data, count, type, 0, node_impl_));
+}
+#endif
+
 template <typename T>
 T Comm::allreduce(T x, Omega_h_Op op) const {
+  CommCounter counter(library_, "allreduce", I64(sizeof(T)));
 #ifdef OMEGA_H_USE_MPI
-  CALL(MPI_Allreduce(
-      MPI_IN_PLACE, &x, 1, MpiTraits<T>::datatype(), mpi_op(op), impl_));
+  allreduce_in_place(&x, 1, MpiTraits<T>::datatype(), mpi_op(op));
 #else
+  if (group_) {
+    /* combine in rank order so that all ranks get the same bits */
+    auto posts = group_->publish(rank_, &x);
+    auto y = *static_cast<T const*>(posts[0]);
+    for (I32 r = 1; r < group_->size; ++r) {
+      y = apply_op(op, y, *static_cast<T const*>(posts[r]));
+    }
+    group_->barrier();
+    return y;
+  }
   (void)op;
 #endif
   return x;
@@ -179,32 +466,163 @@ bool Comm::reduce_and(bool x) const {
 }
 
 #ifdef OMEGA_H_USE_MPI
-static void mpi_add_int128(void* a, void* b, int*, MPI_Datatype*) {
+static void mpi_add_int128(void* a, void* b, int* n, MPI_Datatype*) {
   Int128* a2 = static_cast<Int128*>(a);
   Int128* b2 = static_cast<Int128*>(b);
-  *b2 = *b2 + *a2;
+  for (int i = 0; i < *n; ++i) b2[i] = b2[i] + a2[i];
 }
 #endif
 
 Int128 Comm::add_int128(Int128 x) const {
+  add_int128(&x, 1);
+  return x;
+}
+
+void Comm::add_int128(Int128* x, Int n) const {
+  CommCounter counter(library_, "allreduce", I64(n) * I64(sizeof(Int128)));
 #ifdef OMEGA_H_USE_MPI
+  MPI_Datatype type;
+  CALL(MPI_Type_contiguous(int(sizeof(Int128)), MPI_BYTE, &type));
+  CALL(MPI_Type_commit(&type));
   MPI_Op op;
   int commute = true;
   CALL(MPI_Op_create(mpi_add_int128, commute, &op));
-  CALL(MPI_Allreduce(MPI_IN_PLACE, &x, sizeof(Int128), MPI_PACKED, op, impl_));
+  allreduce_in_place(x, n, type, op);
   CALL(MPI_Op_free(&op));
+  CALL(MPI_Type_free(&type));
+#else
+  if (group_) {
+    auto posts = group_->publish(rank_, x);
+    auto first = static_cast<Int128 const*>(posts[0]);
+    std::vector<Int128> y(first, first + n);
+    for (I32 r = 1; r < group_->size; ++r) {
+      auto other = static_cast<Int128 const*>(posts[r]);
+      for (std::size_t i = 0; i < y.size(); ++i) y[i] = y[i] + other[i];
+    }
+    group_->barrier();
+    std::copy(y.begin(), y.end(), x);
+  }
 #endif
-  return x;
+}
+
+/* one scalar of a ReduceBatch, widened so that all
+   ranks and all types share one layout */
+struct ReduceSlot {
+  I64 integer;
+  Real real;
+  I32 op;
+  I32 is_real;
+};
+
+template <typename T>
+static void load_slot(void const* data, ReduceSlot* slot) {
+  slot->integer = I64(*static_cast<T const*>(data));
+  slot->is_real = 0;
+}
+
+template <>
+void load_slot<Real>(void const* data, ReduceSlot* slot) {
+  slot->real = *static_cast<Real const*>(data);
+  slot->is_real = 1;
+}
+
+template <typename T>
+static void store_slot(ReduceSlot const& slot, void* data) {
+  *static_cast<T*>(data) = static_cast<T>(slot.integer);
+}
+
+template <>
+void store_slot<Real>(ReduceSlot const& slot, void* data) {
+  *static_cast<Real*>(data) = slot.real;
+}
+
+static void combine_slots(ReduceSlot const* a, ReduceSlot* b, int n) {
+  for (int i = 0; i < n; ++i) {
+    auto op = Omega_h_Op(b[i].op);
+    if (b[i].is_real) {
+      b[i].real = apply_op(op, b[i].real, a[i].real);
+    } else {
+      b[i].integer = apply_op(op, b[i].integer, a[i].integer);
+    }
+  }
+}
+
+#ifdef OMEGA_H_USE_MPI
+static void mpi_combine_slots(void* a, void* b, int* n, MPI_Datatype*) {
+  combine_slots(static_cast<ReduceSlot const*>(a),
+      static_cast<ReduceSlot*>(b), *n);
+}
+#endif
+
+template <typename T>
+void ReduceBatch::add(T* value, Omega_h_Op op) {
+  entries_.push_back({value, op, load_slot<T>, store_slot<T>});
+}
+
+void ReduceBatch::allreduce(CommPtr comm) {
+  auto n = int(entries_.size());
+  if (n == 0) return;
+  std::vector<ReduceSlot> slots(entries_.size());
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    entries_[i].load(entries_[i].data, &slots[i]);
+    slots[i].op = I32(entries_[i].op);
+  }
+  CommCounter counter(
+      comm->library_, "allreduce", I64(n) * I64(sizeof(ReduceSlot)));
+#ifdef OMEGA_H_USE_MPI
+  /* a derived type keeps MPI from splitting a slot between
+     two calls of the operation */
+  MPI_Datatype type;
+  CALL(MPI_Type_contiguous(int(sizeof(ReduceSlot)), MPI_BYTE, &type));
+  CALL(MPI_Type_commit(&type));
+  MPI_Op op;
+  int commute = true;
+  CALL(MPI_Op_create(mpi_combine_slots, commute, &op));
+  comm->allreduce_in_place(slots.data(), n, type, op);
+  CALL(MPI_Op_free(&op));
+  CALL(MPI_Type_free(&type));
+#else
+  if (comm->group_) {
+    auto group = comm->group_;
+    auto posts = group->publish(comm->rank_, slots.data());
+    std::vector<ReduceSlot> result(
+        static_cast<ReduceSlot const*>(posts[0]),
+        static_cast<ReduceSlot const*>(posts[0]) + n);
+    for (I32 r = 1; r < group->size; ++r) {
+      combine_slots(static_cast<ReduceSlot const*>(posts[r]), result.data(), n);
+    }
+    group->barrier();
+    slots = result;
+  }
+#endif
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    entries_[i].store(slots[i], entries_[i].data);
+  }
+  entries_.clear();
 }
 
 template <typename T>
 T Comm::exscan(T x, Omega_h_Op op) const {
+  CommCounter counter(library_, "exscan", I64(sizeof(T)));
 #ifdef OMEGA_H_USE_MPI
   CALL(MPI_Exscan(
       MPI_IN_PLACE, &x, 1, MpiTraits<T>::datatype(), mpi_op(op), impl_));
   if (rank() == 0) x = 0;
   return x;
 #else
+  if (group_ && rank_ > 0) {
+    auto posts = group_->publish(rank_, &x);
+    auto y = *static_cast<T const*>(posts[0]);
+    for (I32 r = 1; r < rank_; ++r) {
+      y = apply_op(op, y, *static_cast<T const*>(posts[r]));
+    }
+    group_->barrier();
+    return y;
+  }
+  if (group_) {
+    group_->publish(rank_, &x);
+    group_->barrier();
+  }
   (void)op;
   (void)x;
   return 0;
@@ -213,21 +631,31 @@ T Comm::exscan(T x, Omega_h_Op op) const {
 
 template <typename T>
 void Comm::bcast(T& x) const {
+  CommCounter counter(library_, "bcast", I64(sizeof(T)));
 #ifdef OMEGA_H_USE_MPI
   CALL(MPI_Bcast(&x, 1, MpiTraits<T>::datatype(), 0, impl_));
 #else
-  (void)x;
+  if (group_) {
+    auto posts = group_->publish(rank_, &x);
+    if (rank_ != 0) x = *static_cast<T const*>(posts[0]);
+    group_->barrier();
+  }
 #endif
 }
 
 void Comm::bcast_string(std::string& s) const {
+  CommCounter counter(library_, "bcast", I64(s.length()));
 #ifdef OMEGA_H_USE_MPI
   I32 len = static_cast<I32>(s.length());
   bcast(len);
   s.resize(static_cast<std::size_t>(len));
   CALL(MPI_Bcast(&s[0], len, MPI_CHAR, 0, impl_));
 #else
-  (void)s;
+  if (group_) {
+    auto posts = group_->publish(rank_, &s);
+    if (rank_ != 0) s = *static_cast<std::string const*>(posts[0]);
+    group_->barrier();
+  }
 #endif
 }
 
@@ -349,10 +777,206 @@ static int Neighbor_alltoallv(HostRead<I32> sources, HostRead<I32> destinations,
 #endif  // end if MPI_VERSION < 3
 }
 
+/* the compressed wire format of alltoallv() (see --osh-compress).
+   each message starts with a byte naming its encoding:
+   integers are delta encoded and written as zigzag varints, while
+   other types have their bytes shuffled (all first bytes, then all
+   second bytes, ...) and deflated.
+   a message that does not get smaller is sent as it is */
+
+enum { WIRE_RAW = 0, WIRE_VARINT = 1, WIRE_DEFLATE = 2 };
+
+static int const compressed_tag = 43;
+
+typedef std::vector<unsigned char> WireBytes;
+
+template <typename T>
+struct WireTraits {
+  enum { is_integer = 0 };
+};
+
+template <>
+struct WireTraits<I32> {
+  enum { is_integer = 1 };
+};
+
+template <>
+struct WireTraits<I64> {
+  enum { is_integer = 1 };
+};
+
+template <typename T>
+static void encode_varints(T const* data, LO n, WireBytes& out) {
+  std::uint64_t prev = 0;
+  for (LO i = 0; i < n; ++i) {
+    auto x = std::uint64_t(I64(data[i]));
+    auto delta = I64(x - prev);
+    prev = x;
+    auto zigzag = (std::uint64_t(delta) << 1) ^ std::uint64_t(delta >> 63);
+    while (zigzag >= 0x80) {
+      out.push_back(static_cast<unsigned char>(zigzag | 0x80));
+      zigzag >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(zigzag));
+  }
+}
+
+template <typename T>
+static void decode_varints(unsigned char const* in, T* data, LO n) {
+  std::uint64_t prev = 0;
+  for (LO i = 0; i < n; ++i) {
+    std::uint64_t zigzag = 0;
+    for (int shift = 0;; shift += 7) {
+      auto byte = *in++;
+      zigzag |= std::uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) break;
+    }
+    auto delta = std::uint64_t(I64(zigzag >> 1) ^ -I64(zigzag & 1));
+    prev += delta;
+    data[i] = static_cast<T>(I64(prev));
+  }
+}
+
+#ifdef OMEGA_H_USE_ZLIB
+static void deflate_shuffled(
+    unsigned char const* bytes, LO n, int width, WireBytes& out) {
+  auto nbytes = std::size_t(n) * std::size_t(width);
+  WireBytes shuffled(nbytes);
+  for (int b = 0; b < width; ++b) {
+    for (LO i = 0; i < n; ++i) {
+      shuffled[std::size_t(b) * std::size_t(n) + std::size_t(i)] =
+          bytes[std::size_t(i) * std::size_t(width) + std::size_t(b)];
+    }
+  }
+  auto offset = out.size();
+  auto dest_bytes = ::compressBound(uLong(nbytes));
+  out.resize(offset + dest_bytes);
+  OMEGA_H_CHECK(Z_OK == ::compress2(&out[offset], &dest_bytes,
+                            shuffled.data(), uLong(nbytes), Z_BEST_SPEED));
+  out.resize(offset + dest_bytes);
+}
+
+static void inflate_shuffled(unsigned char const* in, std::size_t in_bytes,
+    unsigned char* bytes, LO n, int width) {
+  auto nbytes = std::size_t(n) * std::size_t(width);
+  WireBytes shuffled(nbytes);
+  auto dest_bytes = uLong(nbytes);
+  OMEGA_H_CHECK(
+      Z_OK == ::uncompress(shuffled.data(), &dest_bytes, in, uLong(in_bytes)));
+  OMEGA_H_CHECK(dest_bytes == nbytes);
+  for (int b = 0; b < width; ++b) {
+    for (LO i = 0; i < n; ++i) {
+      bytes[std::size_t(i) * std::size_t(width) + std::size_t(b)] =
+          shuffled[std::size_t(b) * std::size_t(n) + std::size_t(i)];
+    }
+  }
+}
+#endif
+
+template <typename T>
+static void encode_message(T const* data, LO n, WireBytes& out) {
+  auto nbytes = std::size_t(n) * sizeof(T);
+  out.clear();
+  if (WireTraits<T>::is_integer) {
+    out.push_back(WIRE_VARINT);
+    encode_varints(data, n, out);
+  } else {
+#ifdef OMEGA_H_USE_ZLIB
+    out.push_back(WIRE_DEFLATE);
+    deflate_shuffled(reinterpret_cast<unsigned char const*>(data), n,
+        int(sizeof(T)), out);
+#endif
+  }
+  if (out.empty() || out.size() > nbytes) {
+    out.resize(1 + nbytes);
+    out[0] = WIRE_RAW;
+    std::memcpy(&out[1], data, nbytes);
+  }
+}
+
+template <typename T>
+static void decode_message(WireBytes const& in, T* data, LO n) {
+  auto nbytes = std::size_t(n) * sizeof(T);
+  OMEGA_H_CHECK(!in.empty());
+  switch (in[0]) {
+    case WIRE_RAW:
+      OMEGA_H_CHECK(in.size() == 1 + nbytes);
+      std::memcpy(data, &in[1], nbytes);
+      return;
+    case WIRE_VARINT:
+      decode_varints(&in[1], data, n);
+      return;
+#ifdef OMEGA_H_USE_ZLIB
+    case WIRE_DEFLATE:
+      inflate_shuffled(&in[1], in.size() - 1,
+          reinterpret_cast<unsigned char*>(data), n, int(sizeof(T)));
+      return;
+#endif
+  }
+  OMEGA_H_NORETURN();
+}
+
+/* messages of at least (threshold) bytes are taken out of the
+   neighborhood exchange, since their receivers cannot know their
+   compressed sizes in advance, and go point-to-point instead */
+template <typename T>
+static void compressed_alltoallv(MPI_Comm comm, HostRead<I32> sources,
+    HostRead<I32> destinations, HostRead<T> sendbuf, HostRead<LO> sendcounts,
+    HostRead<LO> sdispls, HostWrite<T> recvbuf, HostRead<LO> recvcounts,
+    HostRead<LO> rdispls, LO threshold) {
+  auto is_big = [=](LO count) {
+    return I64(count) * I64(sizeof(T)) >= I64(threshold);
+  };
+  auto ndsts = destinations.size();
+  auto nsrcs = sources.size();
+  std::vector<WireBytes> encoded(static_cast<std::size_t>(ndsts));
+  std::vector<MPI_Request> sendreqs;
+  std::vector<int> small_sendcounts(static_cast<std::size_t>(ndsts));
+  for (LO i = 0; i < ndsts; ++i) {
+    if (!is_big(sendcounts[i])) {
+      small_sendcounts[std::size_t(i)] = sendcounts[i];
+      continue;
+    }
+    small_sendcounts[std::size_t(i)] = 0;
+    auto& bytes = encoded[std::size_t(i)];
+    encode_message(sendbuf.nonnull_data() + sdispls[i], sendcounts[i], bytes);
+    sendreqs.push_back(MPI_REQUEST_NULL);
+    CALL(MPI_Isend(bytes.data(), int(bytes.size()), MPI_BYTE, destinations[i],
+        compressed_tag, comm, &sendreqs.back()));
+  }
+  std::vector<int> small_recvcounts(static_cast<std::size_t>(nsrcs));
+  for (LO i = 0; i < nsrcs; ++i) {
+    small_recvcounts[std::size_t(i)] =
+        is_big(recvcounts[i]) ? 0 : recvcounts[i];
+  }
+  CALL(Neighbor_alltoallv(sources, destinations, sendbuf.nonnull_data(),
+      small_sendcounts.data(), sdispls.nonnull_data(), MpiTraits<T>::datatype(),
+      recvbuf.nonnull_data(), small_recvcounts.data(), rdispls.nonnull_data(),
+      MpiTraits<T>::datatype(), comm));
+  WireBytes bytes;
+  for (LO i = 0; i < nsrcs; ++i) {
+    if (!is_big(recvcounts[i])) continue;
+    MPI_Status status;
+    CALL(MPI_Probe(sources[i], compressed_tag, comm, &status));
+    int nbytes;
+    CALL(MPI_Get_count(&status, MPI_BYTE, &nbytes));
+    bytes.resize(std::size_t(nbytes));
+    CALL(MPI_Recv(bytes.data(), nbytes, MPI_BYTE, sources[i], compressed_tag,
+        comm, MPI_STATUS_IGNORE));
+    decode_message(bytes, recvbuf.data() + rdispls[i], recvcounts[i]);
+  }
+  CALL(MPI_Waitall(
+      int(sendreqs.size()), sendreqs.data(), MPI_STATUSES_IGNORE));
+}
+
 #endif  // end ifdef OMEGA_H_USE_MPI
 
 template <typename T>
 Read<T> Comm::allgather(T x) const {
+  CommCounter counter(library_, "allgather", 0);
+  counter.set_exchange(host_dsts_.size(), host_dsts_.size(),
+      I64(host_dsts_.size()) * I64(sizeof(T)),
+      I64(host_srcs_.size()) * I64(sizeof(T)));
 #ifdef OMEGA_H_USE_MPI
   HostWrite<T> recvbuf(srcs_.size());
   CALL(Neighbor_allgather(host_srcs_, host_dsts_, &x, 1,
@@ -360,6 +984,15 @@ Read<T> Comm::allgather(T x) const {
       MpiTraits<T>::datatype(), impl_));
   return recvbuf.write();
 #else
+  if (group_) {
+    auto posts = group_->publish(rank_, &x);
+    HostWrite<T> recvbuf(host_srcs_.size());
+    for (LO i = 0; i < recvbuf.size(); ++i) {
+      recvbuf[i] = *static_cast<T const*>(posts[host_srcs_[i]]);
+    }
+    group_->barrier();
+    return recvbuf.write();
+  }
   if (srcs_.size() == 1) return Read<T>({x});
   return Read<T>({});
 #endif
@@ -367,6 +1000,10 @@ Read<T> Comm::allgather(T x) const {
 
 template <typename T>
 Read<T> Comm::alltoall(Read<T> x) const {
+  CommCounter counter(library_, "alltoall", 0);
+  counter.set_exchange(host_dsts_.size(), host_dsts_.size(),
+      I64(host_dsts_.size()) * I64(sizeof(T)),
+      I64(host_srcs_.size()) * I64(sizeof(T)));
 #ifdef OMEGA_H_USE_MPI
   HostWrite<T> recvbuf(srcs_.size());
   HostRead<T> sendbuf(x);
@@ -375,6 +1012,19 @@ Read<T> Comm::alltoall(Read<T> x) const {
       MpiTraits<T>::datatype(), impl_));
   return recvbuf.write();
 #else
+  if (group_) {
+    HostRead<T> sendbuf(x);
+    ThreadMessages<T> msgs = {&x, sendbuf.nonnull_data(), nullptr,
+        host_dsts_.nonnull_data(), host_dsts_.size()};
+    auto posts = group_->publish(rank_, &msgs);
+    HostWrite<T> recvbuf(host_srcs_.size());
+    for (LO i = 0; i < recvbuf.size(); ++i) {
+      auto& from = *static_cast<ThreadMessages<T> const*>(posts[host_srcs_[i]]);
+      recvbuf[i] = from.data[find_destination(from, rank_)];
+    }
+    group_->barrier();
+    return recvbuf.write();
+  }
   return x;
 #endif
 }
@@ -466,9 +1116,21 @@ void self_send_part2(
 
 #endif
 
+template <typename T>
+static void count_alltoallv(CommCounter* counter, Read<T> sendbuf,
+    Read<LO> sendcounts, Read<LO> rdispls) {
+  if (!counter->counts()) return;
+  counter->set_exchange(sendcounts.size(),
+      count_messages(HostRead<LO>(sendcounts)),
+      I64(sendbuf.size()) * I64(sizeof(T)),
+      I64(rdispls.last()) * I64(sizeof(T)));
+}
+
 template <typename T>
 Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sendcounts_dev,
     Read<LO> sdispls_dev, Read<LO> recvcounts_dev, Read<LO> rdispls_dev) const {
+  CommCounter counter(library_, "alltoallv", 0);
+  count_alltoallv(&counter, sendbuf_dev, sendcounts_dev, rdispls_dev);
 #ifdef OMEGA_H_USE_MPI
 #ifdef OMEGA_H_USE_CUDA
   auto self_data = self_send_part1(self_dst_, self_src_, &sendbuf_dev,
@@ -487,17 +1149,60 @@ Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sendcounts_dev,
   OMEGA_H_CHECK(recvcounts.size() == host_srcs_.size());
   OMEGA_H_CHECK(sdispls.size() == sendcounts.size() + 1);
   OMEGA_H_CHECK(sendbuf.size() == sdispls.last());
-  CALL(Neighbor_alltoallv(host_srcs_, host_dsts_, sendbuf.nonnull_data(),
-      sendcounts.nonnull_data(), sdispls.nonnull_data(),
-      MpiTraits<T>::datatype(), recvbuf.nonnull_data(),
-      recvcounts.nonnull_data(), rdispls.nonnull_data(),
-      MpiTraits<T>::datatype(), impl_));
+  auto compress_threshold = library_ ? library_->compress_threshold() : 0;
+  if (compress_threshold > 0) {
+    compressed_alltoallv(impl_, host_srcs_, host_dsts_, sendbuf, sendcounts,
+        sdispls, recvbuf, recvcounts, rdispls, compress_threshold);
+  } else {
+    CALL(Neighbor_alltoallv(host_srcs_, host_dsts_, sendbuf.nonnull_data(),
+        sendcounts.nonnull_data(), sdispls.nonnull_data(),
+        MpiTraits<T>::datatype(), recvbuf.nonnull_data(),
+        recvcounts.nonnull_data(), rdispls.nonnull_data(),
+        MpiTraits<T>::datatype(), impl_));
+  }
   auto recvbuf_dev = Read<T>(recvbuf.write());
 #ifdef OMEGA_H_USE_CUDA
   self_send_part2(self_data, self_src_, &recvbuf_dev, rdispls_dev);
 #endif
   return recvbuf_dev;
 #else
+  if (group_) {
+    HostRead<T> sendbuf(sendbuf_dev);
+    HostRead<LO> sdispls(sdispls_dev);
+    HostRead<LO> recvcounts(recvcounts_dev);
+    HostRead<LO> rdispls(rdispls_dev);
+    OMEGA_H_CHECK(rdispls.size() == recvcounts.size() + 1);
+    OMEGA_H_CHECK(sendcounts_dev.size() == host_dsts_.size());
+    OMEGA_H_CHECK(recvcounts.size() == host_srcs_.size());
+    OMEGA_H_CHECK(sdispls.size() == sendcounts_dev.size() + 1);
+    OMEGA_H_CHECK(sendbuf.size() == sdispls.last());
+    ThreadMessages<T> msgs = {&sendbuf_dev, sendbuf.nonnull_data(),
+        sdispls.nonnull_data(), host_dsts_.nonnull_data(), host_dsts_.size()};
+    auto posts = group_->publish(rank_, &msgs);
+    Read<T> result;
+    HostWrite<T> recvbuf;
+    if (recvcounts.size() == 1 && recvcounts[0] == rdispls.last()) {
+      /* one message, which may be the sender's whole buffer */
+      auto& from = *static_cast<ThreadMessages<T> const*>(posts[host_srcs_[0]]);
+      if (from.sendbuf->size() == rdispls.last()) result = *from.sendbuf;
+    }
+    if (!result.exists()) {
+      recvbuf = HostWrite<T>(rdispls.last());
+      for (LO i = 0; i < recvcounts.size(); ++i) {
+        auto& from =
+            *static_cast<ThreadMessages<T> const*>(posts[host_srcs_[i]]);
+        auto j = find_destination(from, rank_);
+        auto begin = from.sdispls[j];
+        OMEGA_H_CHECK(from.sdispls[j + 1] - begin == recvcounts[i]);
+        for (LO k = 0; k < recvcounts[i]; ++k) {
+          recvbuf[rdispls[i] + k] = from.data[begin + k];
+        }
+      }
+    }
+    group_->barrier();
+    if (!result.exists()) result = recvbuf.write();
+    return result;
+  }
   (void)sendcounts_dev;
   (void)recvcounts_dev;
   (void)sdispls_dev;
@@ -506,12 +1211,151 @@ Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sendcounts_dev,
 #endif
 }
 
+template <typename T>
+struct Future<T>::State {
+  Read<T> result;
+  Callback callback;
+  bool ready = false;
+#ifdef OMEGA_H_USE_MPI
+  bool received = true;
+  HostRead<T> sendbuf;
+  HostWrite<T> recvbuf;
+  HostRead<LO> sendcounts;
+  HostRead<LO> sdispls;
+  HostRead<LO> recvcounts;
+  HostRead<LO> rdispls;
+  MPI_Request request = MPI_REQUEST_NULL;
+  ~State() {
+    if (request != MPI_REQUEST_NULL) {
+      CALL(MPI_Wait(&request, MPI_STATUS_IGNORE));
+    }
+  }
+#endif
+};
+
+template <typename T>
+Future<T>::Future(Read<T> result) : state_(std::make_shared<State>()) {
+  state_->result = result;
+}
+
+#ifdef OMEGA_H_USE_MPI
+template <typename T>
+Future<T>::Future(HostRead<T> sendbuf, HostWrite<T> recvbuf,
+    HostRead<LO> sendcounts, HostRead<LO> sdispls, HostRead<LO> recvcounts,
+    HostRead<LO> rdispls, MPI_Request request)
+    : state_(std::make_shared<State>()) {
+  state_->sendbuf = sendbuf;
+  state_->recvbuf = recvbuf;
+  state_->sendcounts = sendcounts;
+  state_->sdispls = sdispls;
+  state_->recvcounts = recvcounts;
+  state_->rdispls = rdispls;
+  state_->request = request;
+  state_->received = false;
+}
+#endif
+
+template <typename T>
+void Future<T>::set_callback(Callback callback) {
+  OMEGA_H_CHECK(state_ && !state_->ready);
+  state_->callback = callback;
+}
+
+template <typename T>
+bool Future<T>::completed() {
+  OMEGA_H_CHECK(state_);
+#ifdef OMEGA_H_USE_MPI
+  if (state_->request != MPI_REQUEST_NULL) {
+    int flag;
+    CALL(MPI_Test(&state_->request, &flag, MPI_STATUS_IGNORE));
+    return flag != 0;
+  }
+#endif
+  return true;
+}
+
+template <typename T>
+Read<T> Future<T>::get() {
+  OMEGA_H_CHECK(state_);
+  if (state_->ready) return state_->result;
+#ifdef OMEGA_H_USE_MPI
+  if (!state_->received) {
+    CALL(MPI_Wait(&state_->request, MPI_STATUS_IGNORE));
+    state_->result = state_->recvbuf.write();
+    state_->sendbuf = HostRead<T>();
+    state_->recvbuf = HostWrite<T>();
+    state_->received = true;
+  }
+#endif
+  if (state_->callback) {
+    state_->result = state_->callback(state_->result);
+    state_->callback = Callback();
+  }
+  state_->ready = true;
+  return state_->result;
+}
+
+template <typename T>
+Future<T> Comm::ialltoallv(Read<T> sendbuf_dev, Read<LO> sendcounts_dev,
+    Read<LO> sdispls_dev, Read<LO> recvcounts_dev, Read<LO> rdispls_dev) const {
+#if defined(OMEGA_H_USE_MPI) && MPI_VERSION >= 3 && !defined(OMEGA_H_USE_CUDA)
+  if (!library_ || library_->compress_threshold() <= 0) {
+    /* only the start of the exchange is timed */
+    CommCounter counter(library_, "ialltoallv", 0);
+    count_alltoallv(&counter, sendbuf_dev, sendcounts_dev, rdispls_dev);
+    HostRead<T> sendbuf(sendbuf_dev);
+    HostRead<LO> sendcounts(sendcounts_dev);
+    HostRead<LO> recvcounts(recvcounts_dev);
+    HostRead<LO> sdispls(sdispls_dev);
+    HostRead<LO> rdispls(rdispls_dev);
+    OMEGA_H_CHECK(rdispls.size() == recvcounts.size() + 1);
+    int nrecvd = rdispls.last();
+    HostWrite<T> recvbuf(nrecvd);
+    OMEGA_H_CHECK(sendcounts.size() == host_dsts_.size());
+    OMEGA_H_CHECK(recvcounts.size() == host_srcs_.size());
+    OMEGA_H_CHECK(sdispls.size() == sendcounts.size() + 1);
+    OMEGA_H_CHECK(sendbuf.size() == sdispls.last());
+    MPI_Request request;
+    CALL(MPI_Ineighbor_alltoallv(sendbuf.nonnull_data(),
+        sendcounts.nonnull_data(), sdispls.nonnull_data(),
+        MpiTraits<T>::datatype(), recvbuf.nonnull_data(),
+        recvcounts.nonnull_data(), rdispls.nonnull_data(),
+        MpiTraits<T>::datatype(), impl_, &request));
+    return Future<T>(sendbuf, recvbuf, sendcounts, sdispls, recvcounts,
+        rdispls, request);
+  }
+#endif
+  /* without MPI 3, with the compressed wire format, with the device
+     self-send shortcut or with ranks on threads, fall back to the
+     blocking exchange */
+  return Future<T>(alltoallv(
+      sendbuf_dev, sendcounts_dev, sdispls_dev, recvcounts_dev, rdispls_dev));
+}
+
 void Comm::barrier() const {
+  CommCounter counter(library_, "barrier", 0);
 #ifdef OMEGA_H_USE_MPI
   CALL(MPI_Barrier(impl_));
+#else
+  if (group_) group_->barrier();
 #endif
 }
 
+#ifndef OMEGA_H_USE_MPI
+void run_on_threads(
+    Library* library, I32 nranks, std::function<void(CommPtr)> const& f) {
+  OMEGA_H_CHECK(nranks >= 1);
+  auto group = std::make_shared<ThreadGroup>(nranks);
+  auto run = [&](I32 rank) {
+    f(CommPtr(new Comm(library, group, rank, Read<I32>(), Read<I32>())));
+  };
+  std::vector<std::thread> threads;
+  for (I32 rank = 1; rank < nranks; ++rank) threads.emplace_back(run, rank);
+  run(0);
+  for (auto& thread : threads) thread.join();
+}
+#endif
+
 #undef CALL
 
 #define INST(T)                                                                \
@@ -521,7 +1365,11 @@ void Comm::barrier() const {
   template Read<T> Comm::allgather(T x) const;                                 \
   template Read<T> Comm::alltoall(Read<T> x) const;                            \
   template Read<T> Comm::alltoallv(Read<T> sendbuf, Read<LO> sendcounts,       \
-      Read<LO> sdispls, Read<LO> recvcounts, Read<LO> rdispls) const;
+      Read<LO> sdispls, Read<LO> recvcounts, Read<LO> rdispls) const;          \
+  template Future<T> Comm::ialltoallv(Read<T> sendbuf, Read<LO> sendcounts,    \
+      Read<LO> sdispls, Read<LO> recvcounts, Read<LO> rdispls) const;          \
+  template class Future<T>;                                                    \
+  template void ReduceBatch::add(T* value, Omega_h_Op op);
 INST(I8)
 INST(I32)
 INST(I64)
@@ -1,7 +1,9 @@
 #ifndef OMEGA_H_COMM_HPP
 #define OMEGA_H_COMM_HPP
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <Omega_h_c.h>
 #include <Omega_h_array.hpp>
@@ -14,12 +16,54 @@ static_assert(sizeof(int) == 4, "Omega_h::Comm assumes 32-bit int");
 
 class Library;
 class Comm;
+class ReduceBatch;
+struct ReduceSlot;
+#ifndef OMEGA_H_USE_MPI
+struct ThreadGroup;
+#endif
 
 typedef std::shared_ptr<Comm> CommPtr;
 
+/* the result of a nonblocking exchange (see Comm::ialltoallv).
+   get() waits for the data to arrive and then applies the callback,
+   if one was set.
+   copies refer to the same exchange, and the last one to be destroyed
+   waits for it if nobody called get() */
+template <typename T>
+class Future {
+ public:
+  typedef std::function<Read<T>(Read<T>)> Callback;
+  Future() = default;
+  explicit Future(Read<T> result);
+#ifdef OMEGA_H_USE_MPI
+  Future(HostRead<T> sendbuf, HostWrite<T> recvbuf, HostRead<LO> sendcounts,
+      HostRead<LO> sdispls, HostRead<LO> recvcounts, HostRead<LO> rdispls,
+      MPI_Request request);
+#endif
+  void set_callback(Callback callback);
+  /* true if get() would not wait */
+  bool completed();
+  Read<T> get();
+
+ private:
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
 class Comm {
 #ifdef OMEGA_H_USE_MPI
   MPI_Comm impl_;
+  /* for node-aware reductions (see Library::node_aware()):
+     the ranks on this rank's node, and the first rank of each node.
+     created by the first reduction that needs them */
+  mutable MPI_Comm node_impl_;
+  mutable MPI_Comm leaders_impl_;
+  mutable I8 uses_nodes_;
+#else
+  /* the threads acting as ranks (see run_on_threads),
+     or null for the single-rank communicators */
+  std::shared_ptr<ThreadGroup> group_;
+  I32 rank_;
 #endif
   Library* library_;
   Read<I32> srcs_;
@@ -36,6 +80,8 @@ class Comm {
   MPI_Comm get_impl() const { return impl_; }
 #else
   Comm(Library* library, bool is_graph, bool sends_to_self);
+  Comm(Library* library, std::shared_ptr<ThreadGroup> group, I32 rank,
+      Read<I32> srcs, Read<I32> dsts);
 #endif
   ~Comm();
   Library* library() const;
@@ -53,6 +99,8 @@ class Comm {
   bool reduce_or(bool x) const;
   bool reduce_and(bool x) const;
   Int128 add_int128(Int128 x) const;
+  /* sums each of the (n) values of (x) in one collective */
+  void add_int128(Int128* x, Int n) const;
   template <typename T>
   T exscan(T x, Omega_h_Op op) const;
   template <typename T>
@@ -65,9 +113,52 @@ class Comm {
   template <typename T>
   Read<T> alltoallv(Read<T> sendbuf, Read<LO> sendcounts, Read<LO> sdispls,
       Read<LO> recvcounts, Read<LO> rdispls) const;
+  /* starts the same exchange as alltoallv() and returns without
+     waiting for it. the arguments may be discarded afterwards */
+  template <typename T>
+  Future<T> ialltoallv(Read<T> sendbuf, Read<LO> sendcounts, Read<LO> sdispls,
+      Read<LO> recvcounts, Read<LO> rdispls) const;
   void barrier() const;
+
+ private:
+#ifdef OMEGA_H_USE_MPI
+  bool uses_nodes() const;
+  void allreduce_in_place(void* data, int count, MPI_Datatype type,
+      MPI_Op op) const;
+#endif
+  friend class ReduceBatch;
+};
+
+/* reduces several scalars over the same Comm with one collective.
+   the scalars may differ in type and operation, but every rank must
+   add the same sequence of types and operations */
+class ReduceBatch {
+ public:
+  /* (*value) is replaced by its reduction in allreduce() */
+  template <typename T>
+  void add(T* value, Omega_h_Op op);
+  void allreduce(CommPtr comm);
+
+ private:
+  struct Entry {
+    void* data;
+    Omega_h_Op op;
+    void (*load)(void const*, ReduceSlot*);
+    void (*store)(ReduceSlot const&, void*);
+  };
+  std::vector<Entry> entries_;
 };
 
+#ifndef OMEGA_H_USE_MPI
+/* calls f(comm) on (nranks) threads of this process, where comm
+   is a communicator of (nranks) ranks whose collectives hand buffers
+   directly from one thread to another.
+   f should communicate through comm rather than Library::world(),
+   and returns after all threads have returned */
+void run_on_threads(
+    Library* library, I32 nranks, std::function<void(CommPtr)> const& f);
+#endif
+
 #ifdef OMEGA_H_USE_MPI
 
 #ifdef OMPI_MPI_H
@@ -139,7 +230,12 @@ inline MPI_Op mpi_op(Omega_h_Op op) {
   extern template Read<T> Comm::alltoall(Read<T> x) const;                     \
   extern template Read<T> Comm::alltoallv(Read<T> sendbuf,                     \
       Read<LO> sendcounts, Read<LO> sdispls, Read<LO> recvcounts,              \
-      Read<LO> rdispls) const;
+      Read<LO> rdispls) const;                                                 \
+  extern template Future<T> Comm::ialltoallv(Read<T> sendbuf,                  \
+      Read<LO> sendcounts, Read<LO> sdispls, Read<LO> recvcounts,              \
+      Read<LO> rdispls) const;                                                 \
+  extern template class Future<T>;                                             \
+  extern template void ReduceBatch::add(T* value, Omega_h_Op op);
 OMEGA_H_EXPL_INST_DECL(I8)
 OMEGA_H_EXPL_INST_DECL(I32)
 OMEGA_H_EXPL_INST_DECL(I64)
@@ -2,14 +2,17 @@
 
 #include <array>
 #include <iostream>
+#include <vector>
 
 #include "Omega_h_adj.hpp"
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_bbox.hpp"
 #include "Omega_h_compare.hpp"
 #include "Omega_h_graph.hpp"
 #include "Omega_h_host_few.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_r3d.hpp"
+#include "Omega_h_scan.hpp"
 #include "Omega_h_transfer.hpp"
 
 namespace Omega_h {
@@ -405,70 +408,123 @@ void transfer_conserve_refine(Mesh* old_mesh, TransferOpts const& opts,
       same_ents2old_ents, same_ents2new_ents, op_conservation);
 }
 
-/* intersection-based transfer of density fields.
-   note that this is only used in single-material cavities,
-   and so it should exactly conserve mass in those cases. */
+/* the sizes of the intersections between the new and the old
+   elements of each cavity, stored by row: one row per entry
+   (key, new element) of keys2new_elems, holding one size per old
+   element of the key, in keys2old_elems order.
+   they depend only on geometry, so all density fields share them.
+   work is decomposed by row rather than by cavity so that large
+   cavities do not serialize on one thread.
+   pairs with disjoint bounding boxes do not intersect and are
+   not clipped at all. */
+struct CavIntersections {
+  LOs rows2keys;
+  LOs rows2pairs;
+  Reals sizes;
+};
+
 template <Int dim>
-static void transfer_by_intersection_dim(Mesh* old_mesh, Mesh* new_mesh,
-    TagBase const* tagbase, Cavs cavs, Write<Real> new_data_w) {
+static CavIntersections intersect_cavities_dim(
+    Mesh* old_mesh, Mesh* new_mesh, Cavs cavs) {
   auto keys2old_elems = cavs.keys2old_elems;
   auto keys2new_elems = cavs.keys2new_elems;
-  auto ncomps = tagbase->ncomps();
-  auto old_tag = as<Real>(tagbase);
-  auto old_data = old_tag->array();
+  auto rows2keys = invert_fan(keys2new_elems.a2ab);
+  auto nrows = rows2keys.size();
+  auto row_degrees_w = Write<LO>(nrows);
+  auto count = OMEGA_H_LAMBDA(LO row) {
+    auto key = rows2keys[row];
+    row_degrees_w[row] =
+        keys2old_elems.a2ab[key + 1] - keys2old_elems.a2ab[key];
+  };
+  parallel_for(nrows, count, "intersect_cavities(count)");
+  auto rows2pairs = offset_scan(LOs(row_degrees_w));
+  auto sizes_w = Write<Real>(rows2pairs.last());
   auto old_ev2v = old_mesh->ask_elem_verts();
   auto old_coords = old_mesh->coords();
   auto new_ev2v = new_mesh->ask_elem_verts();
   auto new_coords = new_mesh->coords();
-  auto nkeys = cavs.size();
-  auto f = OMEGA_H_LAMBDA(LO key) {
-    for (auto kne = keys2new_elems.a2ab[key];
-         kne < keys2new_elems.a2ab[key + 1]; ++kne) {
-      auto new_elem = keys2new_elems.ab2b[kne];
-      for (Int comp = 0; comp < ncomps; ++comp) {
-        new_data_w[new_elem * ncomps + comp] = 0;
-      }
-      auto new_verts = gather_verts<dim + 1>(new_ev2v, new_elem);
-      auto new_points = gather_vectors<dim + 1, dim>(new_coords, new_verts);
-      Real total_intersected_size = 0.0;
-      for (auto koe = keys2old_elems.a2ab[key];
-           koe < keys2old_elems.a2ab[key + 1]; ++koe) {
-        auto old_elem = keys2old_elems.ab2b[koe];
-        auto old_verts = gather_verts<dim + 1>(old_ev2v, old_elem);
-        auto old_points = gather_vectors<dim + 1, dim>(old_coords, old_verts);
+  auto f = OMEGA_H_LAMBDA(LO row) {
+    auto key = rows2keys[row];
+    auto new_elem = keys2new_elems.ab2b[row];
+    auto new_verts = gather_verts<dim + 1>(new_ev2v, new_elem);
+    auto new_points = gather_vectors<dim + 1, dim>(new_coords, new_verts);
+    auto new_box = bounding_box(new_points);
+    auto pair = rows2pairs[row];
+    for (auto koe = keys2old_elems.a2ab[key];
+         koe < keys2old_elems.a2ab[key + 1]; ++koe) {
+      auto old_elem = keys2old_elems.ab2b[koe];
+      auto old_verts = gather_verts<dim + 1>(old_ev2v, old_elem);
+      auto old_points = gather_vectors<dim + 1, dim>(old_coords, old_verts);
+      Real size = 0.0;
+      if (intersect(new_box, bounding_box(old_points))) {
         r3d::Polytope<dim> intersection;
         r3d::intersect_simplices(
             intersection, to_r3d(new_points), to_r3d(old_points));
-        auto intersection_size = r3d::measure(intersection);
-        for (Int comp = 0; comp < ncomps; ++comp) {
-          new_data_w[new_elem * ncomps + comp] +=
-              intersection_size * old_data[old_elem * ncomps + comp];
-        }
-        total_intersected_size += intersection_size;
+        size = r3d::measure(intersection);
       }
+      sizes_w[pair++] = size;
+    }
+  };
+  parallel_for(nrows, f, "intersect_cavities");
+  return {rows2keys, rows2pairs, Reals(sizes_w)};
+}
+
+static CavIntersections intersect_cavities(
+    Mesh* old_mesh, Mesh* new_mesh, Cavs cavs) {
+  auto dim = old_mesh->dim();
+  if (dim == 3) return intersect_cavities_dim<3>(old_mesh, new_mesh, cavs);
+  if (dim == 2) return intersect_cavities_dim<2>(old_mesh, new_mesh, cavs);
+  if (dim == 1) return intersect_cavities_dim<1>(old_mesh, new_mesh, cavs);
+  OMEGA_H_NORETURN(CavIntersections());
+}
+
+/* intersection-based transfer of density fields.
+   note that this is only used in single-material cavities,
+   and so it should exactly conserve mass in those cases. */
+static void transfer_by_intersection(TagBase const* tagbase, Cavs cavs,
+    CavIntersections isects, Write<Real> new_data_w) {
+  auto keys2old_elems = cavs.keys2old_elems;
+  auto keys2new_elems = cavs.keys2new_elems;
+  auto rows2keys = isects.rows2keys;
+  auto rows2pairs = isects.rows2pairs;
+  auto sizes = isects.sizes;
+  auto ncomps = tagbase->ncomps();
+  auto old_tag = as<Real>(tagbase);
+  auto old_data = old_tag->array();
+  auto f = OMEGA_H_LAMBDA(LO row) {
+    auto key = rows2keys[row];
+    auto new_elem = keys2new_elems.ab2b[row];
+    for (Int comp = 0; comp < ncomps; ++comp) {
+      new_data_w[new_elem * ncomps + comp] = 0;
+    }
+    Real total_intersected_size = 0.0;
+    auto pair = rows2pairs[row];
+    for (auto koe = keys2old_elems.a2ab[key];
+         koe < keys2old_elems.a2ab[key + 1]; ++koe) {
+      auto old_elem = keys2old_elems.ab2b[koe];
+      auto intersection_size = sizes[pair++];
       for (Int comp = 0; comp < ncomps; ++comp) {
-        new_data_w[new_elem * ncomps + comp] /= total_intersected_size;
+        new_data_w[new_elem * ncomps + comp] +=
+            intersection_size * old_data[old_elem * ncomps + comp];
       }
-    }  // end loop over new elements
+      total_intersected_size += intersection_size;
+    }
+    for (Int comp = 0; comp < ncomps; ++comp) {
+      new_data_w[new_elem * ncomps + comp] /= total_intersected_size;
+    }
   };
-  parallel_for(nkeys, f, "transfer_by_intersection");
+  parallel_for(rows2keys.size(), f, "transfer_by_intersection");
 }
 
-static void transfer_by_intersection(Mesh* old_mesh, Mesh* new_mesh,
-    TagBase const* tagbase, Cavs cavs, Write<Real> new_elem_densities_w) {
-  auto dim = old_mesh->dim();
-  if (dim == 3) {
-    transfer_by_intersection_dim<3>(
-        old_mesh, new_mesh, tagbase, cavs, new_elem_densities_w);
-  } else if (dim == 2) {
-    transfer_by_intersection_dim<2>(
-        old_mesh, new_mesh, tagbase, cavs, new_elem_densities_w);
-  } else if (dim == 1) {
-    transfer_by_intersection_dim<1>(
-        old_mesh, new_mesh, tagbase, cavs, new_elem_densities_w);
-  } else {
-    Omega_h_fail("unsupported dim %d\n", dim);
+static std::vector<TagBase const*> get_conserved_tags(
+    Mesh* mesh, TransferOpts const& opts) {
+  std::vector<TagBase const*> tagbases;
+  auto dim = mesh->dim();
+  for (Int i = 0; i < mesh->ntags(dim); ++i) {
+    auto tagbase = mesh->get_tag(dim, i);
+    if (should_conserve(mesh, opts, dim, tagbase)) tagbases.push_back(tagbase);
   }
+  return tagbases;
 }
 
 void transfer_conserve_swap(Mesh* old_mesh, TransferOpts const& opts,
@@ -478,13 +534,14 @@ void transfer_conserve_swap(Mesh* old_mesh, TransferOpts const& opts,
   auto init_cavs = form_initial_cavs(
       old_mesh, new_mesh, EDGE, keys2edges, keys2prods, prods2new_ents);
   auto dim = old_mesh->dim();
-  for (Int i = 0; i < old_mesh->ntags(dim); ++i) {
-    auto tagbase = old_mesh->get_tag(dim, i);
-    if (should_conserve(old_mesh, opts, dim, tagbase)) {
+  auto tagbases = get_conserved_tags(old_mesh, opts);
+  if (!tagbases.empty()) {
+    auto isects = intersect_cavities(old_mesh, new_mesh, init_cavs);
+    for (auto tagbase : tagbases) {
       auto ncomps = tagbase->ncomps();
       auto new_elem_densities_w = Write<Real>(new_mesh->nelems() * ncomps);
       transfer_by_intersection(
-          old_mesh, new_mesh, tagbase, init_cavs, new_elem_densities_w);
+          tagbase, init_cavs, isects, new_elem_densities_w);
       transfer_common2(old_mesh, new_mesh, dim, same_ents2old_ents,
           same_ents2new_ents, tagbase, new_elem_densities_w);
     }
@@ -513,21 +570,29 @@ void transfer_conserve_coarsen(Mesh* old_mesh, TransferOpts const& opts,
   auto cavs = separate_cavities(
       old_mesh, new_mesh, init_cavs, VERT, keys2verts, &bdry_keys2doms);
   auto dim = old_mesh->dim();
-  for (Int i = 0; i < old_mesh->ntags(dim); ++i) {
-    auto tagbase = old_mesh->get_tag(dim, i);
-    if (should_conserve(old_mesh, opts, dim, tagbase)) {
-      auto ncomps = tagbase->ncomps();
-      auto new_elem_densities_w = Write<Real>(new_mesh->nelems() * ncomps);
-      transfer_by_intersection(old_mesh, new_mesh, tagbase,
-          cavs[NOT_BDRY][NO_COLOR][0], new_elem_densities_w);
-      transfer_by_intersection(old_mesh, new_mesh, tagbase,
-          cavs[TOUCH_BDRY][NO_COLOR][0], new_elem_densities_w);
-      for (auto color_cavs : cavs[KEY_BDRY][CLASS_COLOR]) {
+  auto tagbases = get_conserved_tags(old_mesh, opts);
+  if (!tagbases.empty()) {
+    std::vector<Cavs> cavs_sets;
+    cavs_sets.push_back(cavs[NOT_BDRY][NO_COLOR][0]);
+    cavs_sets.push_back(cavs[TOUCH_BDRY][NO_COLOR][0]);
+    for (auto color_cavs : cavs[KEY_BDRY][CLASS_COLOR]) {
+      cavs_sets.push_back(color_cavs);
+    }
+    std::vector<Write<Real>> new_elem_densities_w;
+    for (auto tagbase : tagbases) {
+      new_elem_densities_w.push_back(
+          Write<Real>(new_mesh->nelems() * tagbase->ncomps()));
+    }
+    for (auto set_cavs : cavs_sets) {
+      auto isects = intersect_cavities(old_mesh, new_mesh, set_cavs);
+      for (std::size_t i = 0; i < tagbases.size(); ++i) {
         transfer_by_intersection(
-            old_mesh, new_mesh, tagbase, color_cavs, new_elem_densities_w);
+            tagbases[i], set_cavs, isects, new_elem_densities_w[i]);
       }
+    }
+    for (std::size_t i = 0; i < tagbases.size(); ++i) {
       transfer_common2(old_mesh, new_mesh, dim, same_ents2old_ents,
-          same_ents2new_ents, tagbase, new_elem_densities_w);
+          same_ents2new_ents, tagbases[i], new_elem_densities_w[i]);
     }
   }
   OpConservation op_conservation;
@@ -2,23 +2,31 @@
 
 #include <cxxabi.h>
 #include <execinfo.h>
+#include <algorithm>
 #include <csignal>
 #include <cstdarg>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 
 #include "Omega_h_cmdline.hpp"
 #include "Omega_h_library.hpp"
+#include "Omega_h_scan.hpp"
 
 namespace Omega_h {
 
 bool should_log_memory = false;
 char* max_memory_stacktrace = nullptr;
+bool should_count_comm = false;
 
 static Library* the_library = nullptr;
 
+/* ranks run on threads (see run_on_threads) share their Library */
+static std::mutex library_mutex;
+
 // stacktrace.h (c) 2008, Timo Bingmann from http://idlebox.net/
 // published under the WTFPL v2.0
 
@@ -112,6 +120,9 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
     std::string msg_str = msg.str();
     Omega_h_fail("%s\n", msg_str.c_str());
   }
+  node_aware_ = false;
+  ranks_per_node_ = 0;
+  compress_threshold_ = 0;
 #ifdef OMEGA_H_USE_MPI
   int mpi_is_init;
   OMEGA_H_CHECK(MPI_SUCCESS == MPI_Initialized(&mpi_is_init));
@@ -138,17 +149,43 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
   auto& self_send_flag =
       cmdline.add_flag("--osh-self-send", "control self send threshold");
   self_send_flag.add_arg<int>("value");
+  cmdline.add_flag(
+      "--osh-node-aware", "reduce within shared-memory nodes first");
+  auto& ranks_per_node_flag = cmdline.add_flag(
+      "--osh-ranks-per-node", "emulate node-aware nodes of this many ranks");
+  ranks_per_node_flag.add_arg<int>("value");
+  auto& compress_flag = cmdline.add_flag("--osh-compress",
+      "compress exchanged messages of at least this many bytes");
+  compress_flag.add_arg<int>("bytes");
+  auto& comm_json_flag = cmdline.add_flag("--osh-comm-json",
+      "write communication counts per code region to a JSON file");
+  comm_json_flag.add_arg<std::string>("path");
   if (argc && argv) {
     OMEGA_H_CHECK(cmdline.parse(world_, argc, *argv));
   }
   Omega_h::should_log_memory = cmdline.parsed("--osh-memory");
   should_time_ = cmdline.parsed("--osh-time");
+  if (cmdline.parsed("--osh-comm-json")) {
+    comm_json_path_ = cmdline.get<std::string>("--osh-comm-json", "path");
+  }
+  should_count_comm = should_time_ || !comm_json_path_.empty();
   bool should_protect = cmdline.parsed("--osh-signal");
   self_send_threshold_ = 1000 * 1000;
   if (cmdline.parsed("--osh-self-send")) {
     self_send_threshold_ = cmdline.get<int>("--osh-self-send", "value");
   }
   silent_ = cmdline.parsed("--osh-silent");
+  if (cmdline.parsed("--osh-compress")) {
+    compress_threshold_ = cmdline.get<int>("--osh-compress", "bytes");
+    OMEGA_H_CHECK(compress_threshold_ > 0);
+  }
+  node_aware_ = cmdline.parsed("--osh-node-aware");
+  if (cmdline.parsed("--osh-ranks-per-node")) {
+    node_aware_ = true;
+    ranks_per_node_ = cmdline.get<int>("--osh-ranks-per-node", "value");
+    OMEGA_H_CHECK(ranks_per_node_ > 0);
+  }
+  migrated_bytes_ = 0;
 #ifdef OMEGA_H_USE_KOKKOSCORE
   if (!Kokkos::DefaultExecutionSpace::is_initialized()) {
     OMEGA_H_CHECK(argc != nullptr);
@@ -165,7 +202,10 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
 }
 
 Library::Library(Library const& other)
-    : world_(other.world_),
+    : compress_threshold_(other.compress_threshold_),
+      node_aware_(other.node_aware_),
+      ranks_per_node_(other.ranks_per_node_),
+      world_(other.world_),
       self_(other.self_)
 #ifdef OMEGA_H_USE_MPI
       ,
@@ -175,7 +215,8 @@ Library::Library(Library const& other)
       ,
       we_called_kokkos_init(other.we_called_kokkos_init)
 #endif
-{
+      ,
+      migrated_bytes_(other.migrated_bytes_) {
 }
 
 Library::~Library() {
@@ -199,6 +240,7 @@ Library::~Library() {
       }
     }
   }
+  if (should_count_comm && the_library == this) report_comm_stats();
   // need to destroy all Comm objects prior to MPI_Finalize()
   world_ = CommPtr();
   self_ = CommPtr();
@@ -231,11 +273,141 @@ CommPtr Library::self() {
 
 void Library::add_to_timer(std::string const& name, double nsecs) {
   if (!should_time_) return;
+  std::lock_guard<std::mutex> lock(library_mutex);
   timers[name] += nsecs;
 }
 
 LO Library::self_send_threshold() const { return self_send_threshold_; }
 
+LO Library::compress_threshold() const { return compress_threshold_; }
+
+bool Library::node_aware() const { return node_aware_; }
+
+Int Library::ranks_per_node() const { return ranks_per_node_; }
+
+void Library::add_migrated_bytes(I64 nbytes) {
+  std::lock_guard<std::mutex> lock(library_mutex);
+  migrated_bytes_ += nbytes;
+}
+
+I64 Library::migrated_bytes() const { return migrated_bytes_; }
+
+CommStats::CommStats()
+    : ncalls(0),
+      nmessages(0),
+      nneighbors(0),
+      nsent_bytes(0),
+      nrecvd_bytes(0),
+      time(0.0) {}
+
+void Library::add_comm_stats(
+    std::string const& site, std::string const& op, CommStats const& stats) {
+  std::lock_guard<std::mutex> lock(library_mutex);
+  auto& total = comm_stats_[std::make_pair(site, op)];
+  total.ncalls += stats.ncalls;
+  total.nmessages += stats.nmessages;
+  total.nneighbors += stats.nneighbors;
+  total.nsent_bytes += stats.nsent_bytes;
+  total.nrecvd_bytes += stats.nrecvd_bytes;
+  total.time += stats.time;
+}
+
+/* gathers every rank's counts on rank 0 as lines of text,
+   which then sums them and prints or writes them */
+void Library::report_comm_stats() {
+  should_count_comm = false;
+  std::stringstream lines;
+  lines.precision(17);
+  for (auto& pair : comm_stats_) {
+    auto& stats = pair.second;
+    lines << pair.first.first << '\t' << pair.first.second << '\t'
+          << stats.ncalls << '\t' << stats.nmessages << '\t'
+          << stats.nneighbors << '\t' << stats.nsent_bytes << '\t'
+          << stats.nrecvd_bytes << '\t' << stats.time << '\n';
+  }
+  auto text = lines.str();
+  auto nsend = LO(text.size());
+  HostWrite<I8> h_sendbuf(nsend);
+  for (LO i = 0; i < nsend; ++i) h_sendbuf[i] = I8(text[std::size_t(i)]);
+  auto to_root = world_->graph(Read<I32>({0}));
+  auto recvcounts = to_root->allgather(nsend);
+  auto recvd = to_root->alltoallv(Read<I8>(h_sendbuf.write()),
+      Read<LO>({nsend}), Read<LO>({0, nsend}), recvcounts,
+      offset_scan(recvcounts));
+  if (world_->rank() != 0) return;
+  HostRead<I8> h_recvd(recvd);
+  std::string all_text(std::size_t(h_recvd.size()), ' ');
+  for (LO i = 0; i < h_recvd.size(); ++i) {
+    all_text[std::size_t(i)] = char(h_recvd[i]);
+  }
+  struct Summary {
+    CommStats total;
+    Real max_time = 0.0;
+    Int nranks = 0;
+  };
+  std::map<std::pair<std::string, std::string>, Summary> summaries;
+  std::istringstream all_lines(all_text);
+  std::string line;
+  while (std::getline(all_lines, line)) {
+    std::istringstream fields(line);
+    std::string site, op;
+    std::getline(fields, site, '\t');
+    std::getline(fields, op, '\t');
+    CommStats stats;
+    fields >> stats.ncalls >> stats.nmessages >> stats.nneighbors >>
+        stats.nsent_bytes >> stats.nrecvd_bytes >> stats.time;
+    auto& summary = summaries[std::make_pair(site, op)];
+    summary.total.ncalls += stats.ncalls;
+    summary.total.nmessages += stats.nmessages;
+    summary.total.nneighbors += stats.nneighbors;
+    summary.total.nsent_bytes += stats.nsent_bytes;
+    summary.total.nrecvd_bytes += stats.nrecvd_bytes;
+    summary.total.time += stats.time;
+    summary.max_time = std::max(summary.max_time, stats.time);
+    ++summary.nranks;
+  }
+  std::ofstream json;
+  if (!comm_json_path_.empty()) {
+    json.open(comm_json_path_.c_str());
+    json.precision(17);
+    json << "[";
+  }
+  bool first = true;
+  for (auto& pair : summaries) {
+    auto& site = pair.first.first;
+    auto& op = pair.first.second;
+    auto& total = pair.second.total;
+    auto max_time = pair.second.max_time;
+    /* the slowest rank over the average rank */
+    auto mean_time = total.time / pair.second.nranks;
+    auto imbalance = (mean_time > 0.0) ? (max_time / mean_time) : 1.0;
+    if (should_time_) {
+      std::cout << "communication in " << site << " (" << op
+                << "): " << total.ncalls << " calls, " << total.nmessages
+                << " messages, "
+                << Real(total.nneighbors) / Real(total.ncalls)
+                << " neighbors per call, " << total.nsent_bytes
+                << " bytes sent, " << total.nrecvd_bytes
+                << " bytes received, " << max_time
+                << " seconds on the slowest rank, imbalance " << imbalance
+                << '\n';
+    }
+    if (json.is_open()) {
+      json << (first ? "\n" : ",\n") << "  {\"site\": \"" << site
+           << "\", \"op\": \"" << op << "\", \"calls\": " << total.ncalls
+           << ", \"messages\": " << total.nmessages
+           << ", \"neighbors\": " << total.nneighbors
+           << ", \"sent_bytes\": " << total.nsent_bytes
+           << ", \"received_bytes\": " << total.nrecvd_bytes
+           << ", \"max_time\": " << max_time
+           << ", \"mean_time\": " << mean_time
+           << ", \"imbalance\": " << imbalance << "}";
+    }
+    first = false;
+  }
+  if (json.is_open()) json << "\n]\n";
+}
+
 void add_to_global_timer(std::string const& name, double nsecs) {
   the_library->add_to_timer(name, nsecs);
 }
@@ -6,6 +6,8 @@
 namespace Omega_h {
 extern bool should_log_memory;
 extern char* max_memory_stacktrace;
+/* set by --osh-time and --osh-comm-json */
+extern bool should_count_comm;
 void print_stacktrace(std::ostream& out, int max_frames);
 void add_to_global_timer(std::string const& name, double nsecs);
 }  // namespace Omega_h
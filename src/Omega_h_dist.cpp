@@ -1,5 +1,7 @@
 #include "Omega_h_dist.hpp"
 
+#include <cstring>
+
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_loop.hpp"
 #include "Omega_h_map.hpp"
@@ -61,6 +63,7 @@ void Dist::set_dest_ranks(Read<I32> items2ranks) {
   auto fdegrees = get_degrees(msgs2content_[F]);
   auto rdegrees = comm_[F]->alltoall(fdegrees);
   msgs2content_[R] = offset_scan(rdegrees);
+  for (Int i = 0; i < 2; ++i) plans_[i] = std::make_shared<Plans>();
   end_code();
 }
 
@@ -89,29 +92,83 @@ Dist Dist::invert() const {
     out.items2content_[i] = items2content_[1 - i];
     out.msgs2content_[i] = msgs2content_[1 - i];
     out.comm_[i] = comm_[1 - i];
+    out.plans_[i] = plans_[1 - i];
   }
   return out;
 }
 
 template <typename T>
 Read<T> Dist::exch(Read<T> data, Int width) const {
-  if (roots2items_[F].exists()) {
-    data = expand(data, roots2items_[F], width);
-  }
-  if (items2content_[F].exists()) {
-    data = permute(data, items2content_[F], width);
-  }
-  auto sendcounts = multiply_each_by(width, get_degrees(msgs2content_[F]));
-  auto recvcounts = multiply_each_by(width, get_degrees(msgs2content_[R]));
-  auto sdispls = offset_scan(sendcounts);
-  auto rdispls = offset_scan(recvcounts);
-  data = comm_[F]->alltoallv(data, sendcounts, sdispls, recvcounts, rdispls);
+  data = items_to_content(data, width);
+  auto& plan = get_plan(width);
+  data = comm_[F]->alltoallv(
+      data, plan.sendcounts, plan.sdispls, plan.recvcounts, plan.rdispls);
   if (items2content_[R].exists()) {
     data = unmap(items2content_[R], data, width);
   }
   return data;
 }
 
+template <typename T>
+Future<T> Dist::exch_begin(Read<T> data, Int width) const {
+  data = items_to_content(data, width);
+  auto& plan = get_plan(width);
+  auto future = comm_[F]->ialltoallv(
+      data, plan.sendcounts, plan.sdispls, plan.recvcounts, plan.rdispls);
+  if (items2content_[R].exists()) {
+    auto rcontent2items = items2content_[R];
+    future.set_callback([=](Read<T> content_data) {
+      return unmap(rcontent2items, content_data, width);
+    });
+  }
+  return future;
+}
+
+/* each sent value travels with its position in the message
+   that exch() would have sent, which the receiver turns back
+   into its content and then its item */
+template <typename T>
+Future<T> Dist::exch_subset_begin(Read<I8> roots_are_sent, Read<T> data,
+    Int width, Future<LO>* p_items) const {
+  auto content_is_sent = items_to_content(roots_are_sent, 1);
+  auto content_data = items_to_content(data, width);
+  auto sent2content = collect_marked(content_is_sent);
+  auto fmsgs2content = msgs2content_[F];
+  auto content_scan = offset_scan(content_is_sent);
+  auto sdispls = unmap(fmsgs2content, content_scan, 1);
+  auto sendcounts = get_degrees(sdispls);
+  auto recvcounts = comm_[F]->alltoall(sendcounts);
+  auto rdispls = offset_scan(recvcounts);
+  auto content2msgs = invert_fan(fmsgs2content);
+  Write<LO> sent_offsets(sent2content.size());
+  auto f = OMEGA_H_LAMBDA(LO sent) {
+    auto content = sent2content[sent];
+    sent_offsets[sent] = content - fmsgs2content[content2msgs[content]];
+  };
+  parallel_for(sent2content.size(), f, "exch_subset_begin");
+  auto items = comm_[F]->ialltoallv(
+      LOs(sent_offsets), sendcounts, sdispls, recvcounts, rdispls);
+  auto rmsgs2content = msgs2content_[R];
+  auto has_perm = items2content_[R].exists();
+  auto rcontent2items =
+      has_perm ? invert_permutation(items2content_[R]) : LOs();
+  items.set_callback([=](LOs recvd_offsets) {
+    auto recvd2msgs = invert_fan(rdispls);
+    Write<LO> recvd2items(recvd_offsets.size());
+    auto g = OMEGA_H_LAMBDA(LO recvd) {
+      auto content =
+          rmsgs2content[recvd2msgs[recvd]] + recvd_offsets[recvd];
+      recvd2items[recvd] = has_perm ? rcontent2items[content] : content;
+    };
+    parallel_for(recvd_offsets.size(), g, "exch_subset_end");
+    return LOs(recvd2items);
+  });
+  *p_items = items;
+  return comm_[F]->ialltoallv(unmap(sent2content, content_data, width),
+      multiply_each_by(width, sendcounts), multiply_each_by(width, sdispls),
+      multiply_each_by(width, recvcounts), multiply_each_by(width, rdispls));
+}
+
 template <typename T>
 Read<T> Dist::exch_reduce(Read<T> data, Int width, Omega_h_Op op) const {
   Read<T> item_data = exch(data, width);
@@ -171,6 +228,7 @@ void Dist::change_comm(CommPtr new_comm) {
   // replace parent_comm_
   parent_comm_ = new_comm;
   // thats it! since all rank information is queried from graph comms
+  // (the neighbor order is kept, so cached plans remain valid)
 }
 
 Remotes Dist::exch(Remotes data, Int width) const {
@@ -186,11 +244,149 @@ void Dist::copy(Dist const& other) {
     items2content_[i] = other.items2content_[i];
     msgs2content_[i] = other.msgs2content_[i];
     comm_[i] = other.comm_[i];
+    plans_[i] = other.plans_[i];
+  }
+}
+
+template <typename T>
+Read<T> Dist::items_to_content(Read<T> data, Int width) const {
+  if (roots2items_[F].exists()) {
+    data = expand(data, roots2items_[F], width);
+  }
+  if (items2content_[F].exists()) {
+    data = permute(data, items2content_[F], width);
+  }
+  return data;
+}
+
+DistPlan const& Dist::get_plan(Int width) const {
+  OMEGA_H_CHECK(plans_[F]);
+  auto it = plans_[F]->find(width);
+  if (it != plans_[F]->end()) return it->second;
+  DistPlan plan;
+  plan.sendcounts = multiply_each_by(width, get_degrees(msgs2content_[F]));
+  plan.recvcounts = multiply_each_by(width, get_degrees(msgs2content_[R]));
+  plan.sdispls = offset_scan(plan.sendcounts);
+  plan.rdispls = offset_scan(plan.recvcounts);
+  return (*plans_[F])[width] = plan;
+}
+
+/* within the message to one neighbor, the values of each array
+   are contiguous (one block per array, in the order they were added).
+   packing writes each root's values straight to the content positions
+   of its items, and unpacking reads each item's values from its
+   content position, so the expand/permute/unmap steps of exch()
+   happen during the copy into and out of the byte buffer */
+
+struct ExchBlocks {
+  LOs msgs2content;
+  LOs content2msgs;
+  Int rowbytes;
+  Int offset;
+  Int nbytes;
+  OMEGA_H_DEVICE LO operator()(LO content) const {
+    auto msg = content2msgs[content];
+    auto b = msgs2content[msg];
+    auto e = msgs2content[msg + 1];
+    return b * rowbytes + (e - b) * offset + (content - b) * nbytes;
+  }
+};
+
+template <typename T>
+static void pack_exch_rows(void* data, Int width, LOs roots2items,
+    LOs items2content, ExchBlocks blocks, Write<I8> bytes) {
+  auto a = *static_cast<Read<T>*>(data);
+  auto nroots = divide_no_remainder(a.size(), width);
+  auto has_fan = roots2items.exists();
+  auto has_perm = items2content.exists();
+  OMEGA_H_CHECK(nroots == (has_fan ? roots2items.size() - 1
+                                   : blocks.content2msgs.size()));
+  auto f = OMEGA_H_LAMBDA(LO root) {
+    auto b = has_fan ? roots2items[root] : root;
+    auto e = has_fan ? roots2items[root + 1] : root + 1;
+    for (auto item = b; item < e; ++item) {
+      auto content = has_perm ? items2content[item] : item;
+      auto out = &bytes[blocks(content)];
+      for (Int j = 0; j < width; ++j) {
+        T val = a[root * width + j];
+        std::memcpy(out + j * Int(sizeof(T)), &val, sizeof(T));
+      }
+    }
+  };
+  parallel_for(nroots, f, "pack_exch_rows");
+}
+
+template <typename T>
+static void unpack_exch_rows(void* data, Int width, LOs items2content,
+    ExchBlocks blocks, Read<I8> bytes) {
+  auto nitems = blocks.content2msgs.size();
+  auto has_perm = items2content.exists();
+  Write<T> a(nitems * width);
+  auto f = OMEGA_H_LAMBDA(LO item) {
+    auto content = has_perm ? items2content[item] : item;
+    auto in = &bytes[blocks(content)];
+    for (Int j = 0; j < width; ++j) {
+      T val;
+      std::memcpy(&val, in + j * Int(sizeof(T)), sizeof(T));
+      a[item * width + j] = val;
+    }
+  };
+  parallel_for(nitems, f, "unpack_exch_rows");
+  *static_cast<Read<T>*>(data) = a;
+}
+
+template <typename T>
+void ExchBatch::add(Read<T>* data, Int width) {
+  Entry entry;
+  entry.data = data;
+  entry.width = width;
+  entry.nbytes = width * Int(sizeof(T));
+  entry.pack = pack_exch_rows<T>;
+  entry.unpack = unpack_exch_rows<T>;
+  entries_.push_back(entry);
+}
+
+void ExchBatch::exch(Dist const& dist) {
+  if (entries_.empty()) return;
+  begin_code("ExchBatch::exch");
+  ExchBlocks blocks[2];
+  for (Int i = 0; i < 2; ++i) {
+    blocks[i].msgs2content = dist.msgs2content_[i];
+    blocks[i].content2msgs = invert_fan(dist.msgs2content_[i]);
+    blocks[i].rowbytes = 0;
+    for (auto& entry : entries_) blocks[i].rowbytes += entry.nbytes;
   }
+  auto rowbytes = blocks[Dist::F].rowbytes;
+  Write<I8> sent(dist.nitems() * rowbytes);
+  Int offset = 0;
+  for (auto& entry : entries_) {
+    blocks[Dist::F].offset = offset;
+    blocks[Dist::F].nbytes = entry.nbytes;
+    entry.pack(entry.data, entry.width, dist.roots2items_[Dist::F],
+        dist.items2content_[Dist::F], blocks[Dist::F], sent);
+    offset += entry.nbytes;
+  }
+  auto& plan = dist.get_plan(rowbytes);
+  auto received = dist.comm_[Dist::F]->alltoallv(Read<I8>(sent),
+      plan.sendcounts, plan.sdispls, plan.recvcounts, plan.rdispls);
+  offset = 0;
+  for (auto& entry : entries_) {
+    blocks[Dist::R].offset = offset;
+    blocks[Dist::R].nbytes = entry.nbytes;
+    entry.unpack(entry.data, entry.width, dist.items2content_[Dist::R],
+        blocks[Dist::R], received);
+    offset += entry.nbytes;
+  }
+  entries_.clear();
+  end_code();
 }
 
 #define INST_T(T)                                                              \
+  template void ExchBatch::add(Read<T>* data, Int width);                      \
   template Read<T> Dist::exch(Read<T> data, Int width) const;                  \
+  template Future<T> Dist::exch_begin(Read<T> data, Int width) const;          \
+  template Future<T> Dist::exch_subset_begin(Read<I8> roots_are_sent,          \
+      Read<T> data, Int width, Future<LO>* p_items) const;                     \
   template Read<T> Dist::exch_reduce(Read<T> data, Int width, Omega_h_Op op)   \
       const;
 INST_T(I8)
@@ -1,6 +1,9 @@
 #ifndef OMEGA_H_DIST_HPP
 #define OMEGA_H_DIST_HPP
 
+#include <map>
+#include <vector>
+
 #include <Omega_h_comm.hpp>
 #include <Omega_h_remotes.hpp>
 
@@ -79,12 +82,25 @@ namespace Omega_h {
    sent and received data, respectively.
  */
 
+/* the message counts and displacements of one exch() width */
+struct DistPlan {
+  LOs sendcounts;
+  LOs sdispls;
+  LOs recvcounts;
+  LOs rdispls;
+};
+
 class Dist {
   CommPtr parent_comm_;
   LOs roots2items_[2];
   LOs items2content_[2];
   LOs msgs2content_[2];
   CommPtr comm_[2];
+  /* plans for each width, built on first use.
+     copies of a Dist (such as those returned by Mesh::ask_dist)
+     share them, set_dest_ranks() starts over */
+  typedef std::map<Int, DistPlan> Plans;
+  std::shared_ptr<Plans> plans_[2];
 
  public:
   Dist();
@@ -125,6 +141,20 @@ class Dist {
   Dist invert() const;
   template <typename T>
   Read<T> exch(Read<T> data, Int width) const;
+  /* starts exch() and returns before the data arrives,
+     get() on the result finishes it and returns what exch() would.
+     other work may be done in between */
+  template <typename T>
+  Future<T> exch_begin(Read<T> data, Int width) const;
+  /* like exch_begin(), but only the forward roots marked in
+     (roots_are_sent) are sent, so the messages shrink with them.
+     get() returns the received values, one per received item,
+     and (*p_items) gets the reverse items they belong to.
+     the message sizes change from call to call, so they are
+     exchanged (blocking) before this returns */
+  template <typename T>
+  Future<T> exch_subset_begin(Read<I8> roots_are_sent, Read<T> data,
+      Int width, Future<LO>* p_items) const;
   template <typename T>
   Read<T> exch_reduce(Read<T> data, Int width, Omega_h_Op op) const;
   CommPtr parent_comm() const;
@@ -146,11 +176,42 @@ class Dist {
 
  private:
   void copy(Dist const& other);
+  template <typename T>
+  Read<T> items_to_content(Read<T> data, Int width) const;
+  DistPlan const& get_plan(Int width) const;
   enum { F, R };
+  friend class ExchBatch;
+};
+
+struct ExchBlocks;
+
+/* exchanges several arrays over the same Dist with one message
+   per neighbor. the arrays may differ in type and width, but all
+   have one entry (of their width) per source root, as in exch() */
+class ExchBatch {
+ public:
+  /* (data) is replaced by the exchanged array in exch() */
+  template <typename T>
+  void add(Read<T>* data, Int width);
+  void exch(Dist const& dist);
+
+ private:
+  struct Entry {
+    void* data;
+    Int width;
+    Int nbytes;  // per item
+    void (*pack)(void*, Int, LOs, LOs, ExchBlocks, Write<I8>);
+    void (*unpack)(void*, Int, LOs, ExchBlocks, Read<I8>);
+  };
+  std::vector<Entry> entries_;
 };
 
 #define OMEGA_H_EXPL_INST_DECL(T)                                              \
+  extern template void ExchBatch::add(Read<T>* data, Int width);               \
   extern template Read<T> Dist::exch(Read<T> data, Int width) const;           \
+  extern template Future<T> Dist::exch_begin(Read<T> data, Int width) const;   \
+  extern template Future<T> Dist::exch_subset_begin(Read<I8> roots_are_sent,   \
+      Read<T> data, Int width, Future<LO>* p_items) const;                     \
   extern template Read<T> Dist::exch_reduce<T>(                                \
       Read<T> data, Int width, Omega_h_Op op) const;
 OMEGA_H_EXPL_INST_DECL(I8)
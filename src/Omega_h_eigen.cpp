@@ -25,4 +25,34 @@ Reals get_max_eigenvalues(Int dim, Reals symms) {
   OMEGA_H_NORETURN(Reals());
 }
 
+template <Int dim>
+static void decompose_eigens_dim(
+    Reals symms, Reals* eigenvalues, Reals* eigenvectors) {
+  auto n = divide_no_remainder(symms.size(), symm_ncomps(dim));
+  auto l_w = Write<Real>(n * dim);
+  auto q_w = Write<Real>(n * matrix_ncomps(dim));
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    auto ed = decompose_eigen_symm(get_symm<dim>(symms, i));
+    set_vector(l_w, i, ed.l);
+    set_matrix(q_w, i, ed.q);
+  };
+  parallel_for(n, f, "decompose_eigens");
+  *eigenvalues = l_w;
+  *eigenvectors = q_w;
+}
+
+void decompose_eigens(
+    Int dim, Reals symms, Reals* eigenvalues, Reals* eigenvectors) {
+  if (dim == 3) {
+    return decompose_eigens_dim<3>(symms, eigenvalues, eigenvectors);
+  }
+  if (dim == 2) {
+    return decompose_eigens_dim<2>(symms, eigenvalues, eigenvectors);
+  }
+  if (dim == 1) {
+    return decompose_eigens_dim<1>(symms, eigenvalues, eigenvectors);
+  }
+  OMEGA_H_NORETURN();
+}
+
 }  // end namespace Omega_h
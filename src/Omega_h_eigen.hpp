@@ -359,10 +359,11 @@ OMEGA_H_INLINE Vector<2> schur_sym(Real f, Real g, Real h) {
   Real s = 0.0;
   if (g != 0.0) {
     Real t = (h - f) / (2.0 * g);
+    /* the smaller root, without cancellation */
     if (t >= 0.0) {
       t = 1.0 / (sqrt(1.0 + square(t)) + t);
     } else {
-      t = -1.0 / (sqrt(1.0 + square(t)) + t);
+      t = -1.0 / (sqrt(1.0 + square(t)) - t);
     }
     c = 1.0 / sqrt(1.0 + square(t));
     s = t * c;
@@ -427,6 +428,137 @@ OMEGA_H_INLINE DiagDecomp<dim> decompose_eigen_jacobi(
   return {v, diagonal(a)};
 }
 
+/* a noniterative eigensolver for symmetric 3x3 matrices, after
+   D. Eberly, "A Robust Eigensolver for 3 x 3 Symmetric Matrices", 2014.
+   the eigenvalues come from the trigonometric form of the cubic,
+   the eigenvector of the best separated one from cross products,
+   the next one from a 2x2 problem in its orthogonal complement
+   and the last one as a cross product.
+   near a double root, acos() loses about half of the digits of the
+   two close eigenvalues and mixes their eigenvectors, so one Jacobi
+   rotation in the plane of those two eigenvectors follows.
+   unlike decompose_eigen(), there is no classification of
+   repeated roots and no failure case, which makes it the cheaper
+   choice when decomposing many matrices.
+   the eigenvalues are in increasing order and (q) is orthonormal.
+   the 1x1 and 2x2 versions just call decompose_eigen(). */
+
+OMEGA_H_INLINE Vector<3> symm_eigenvector_far(Matrix<3, 3> a, Real l) {
+  auto r0 = vector_3(a(0, 0) - l, a(0, 1), a(0, 2));
+  auto r1 = vector_3(a(0, 1), a(1, 1) - l, a(1, 2));
+  auto r2 = vector_3(a(0, 2), a(1, 2), a(2, 2) - l);
+  auto c01 = cross(r0, r1);
+  auto c02 = cross(r0, r2);
+  auto c12 = cross(r1, r2);
+  auto d01 = norm_squared(c01);
+  auto d02 = norm_squared(c02);
+  auto d12 = norm_squared(c12);
+  auto c = (d01 >= d02) ? c01 : c02;
+  auto d = max2(d01, d02);
+  c = (d12 > d) ? c12 : c;
+  d = max2(d12, d);
+  return (d > 0.0) ? (c / sqrt(d)) : vector_3(1, 0, 0);
+}
+
+OMEGA_H_INLINE Vector<3> symm_eigenvector_near(
+    Matrix<3, 3> a, Vector<3> w, Real l) {
+  auto u = (fabs(w[0]) > fabs(w[1]))
+               ? (vector_3(-w[2], 0, w[0]) / sqrt(square(w[0]) + square(w[2])))
+               : (vector_3(0, w[2], -w[1]) / sqrt(square(w[1]) + square(w[2])));
+  auto v = cross(w, u);
+  auto m00 = u * (a * u) - l;
+  auto m01 = u * (a * v);
+  auto m11 = v * (a * v) - l;
+  /* the null vector of [m00 m01; m01 m11] is taken from
+     whichever of its rows is larger */
+  auto use_first = (fabs(m00) >= fabs(m11));
+  auto x = use_first ? m00 : m11;
+  auto ax = fabs(x);
+  auto ay = fabs(m01);
+  if (max2(ax, ay) == 0.0) return u;
+  Real cx, cy;
+  if (ax >= ay) {
+    auto t = m01 / x;
+    cx = 1.0 / sqrt(1.0 + square(t));
+    cy = t * cx;
+  } else {
+    auto t = x / m01;
+    cy = 1.0 / sqrt(1.0 + square(t));
+    cx = t * cy;
+  }
+  return use_first ? (cy * u - cx * v) : (cx * u - cy * v);
+}
+
+/* one Jacobi rotation in the plane of eigenvectors (i) and (j) */
+OMEGA_H_INLINE DiagDecomp<3> polish_eigen_pair(
+    Matrix<3, 3> a, DiagDecomp<3> dd, Int i, Int j) {
+  auto ai = a * dd.q[i];
+  auto aj = a * dd.q[j];
+  auto f = dd.q[i] * ai;
+  auto g = dd.q[i] * aj;
+  auto h = dd.q[j] * aj;
+  auto cs = schur_sym(f, g, h);
+  auto c = cs[0];
+  auto s = cs[1];
+  auto qi = c * dd.q[i] - s * dd.q[j];
+  auto qj = s * dd.q[i] + c * dd.q[j];
+  auto li = square(c) * f - 2.0 * c * s * g + square(s) * h;
+  auto lj = square(s) * f + 2.0 * c * s * g + square(c) * h;
+  /* the rotation may swap two nearly equal eigenvalues */
+  auto in_order = (li <= lj);
+  dd.q[i] = in_order ? qi : qj;
+  dd.q[j] = in_order ? qj : qi;
+  dd.l[i] = min2(li, lj);
+  dd.l[j] = max2(li, lj);
+  return dd;
+}
+
+OMEGA_H_INLINE DiagDecomp<3> decompose_eigen_symm(Matrix<3, 3> a) {
+  Real s = 0.0;
+  for (Int j = 0; j < 3; ++j) {
+    for (Int i = 0; i < 3; ++i) s = max2(s, fabs(a(i, j)));
+  }
+  if (s == 0.0) return {identity_matrix<3, 3>(), zero_vector<3>()};
+  a = a / s;
+  auto q = trace(a) / 3.0;
+  auto b = subtract_from_diag(a, q);
+  auto off = square(b(0, 1)) + square(b(0, 2)) + square(b(1, 2));
+  auto p = sqrt((square(b(0, 0)) + square(b(1, 1)) + square(b(2, 2)) +
+                    2.0 * off) /
+                6.0);
+  if (p == 0.0) return {identity_matrix<3, 3>(), vector_3(q, q, q) * s};
+  auto half_det = clamp(determinant(b) / (2.0 * cube(p)), -1.0, 1.0);
+  auto angle = acos(half_det) / 3.0;
+  auto beta2 = 2.0 * cos(angle);
+  auto beta0 = 2.0 * cos(angle + (2.0 * PI / 3.0));
+  auto beta1 = -(beta0 + beta2);
+  auto l = vector_3(q + p * beta0, q + p * beta1, q + p * beta2);
+  /* start from the eigenvalue farthest from the other two */
+  DiagDecomp<3> dd;
+  dd.l = l;
+  if (half_det >= 0.0) {
+    dd.q[2] = symm_eigenvector_far(a, l[2]);
+    dd.q[1] = symm_eigenvector_near(a, dd.q[2], l[1]);
+    dd.q[0] = cross(dd.q[1], dd.q[2]);
+    dd = polish_eigen_pair(a, dd, 0, 1);
+  } else {
+    dd.q[0] = symm_eigenvector_far(a, l[0]);
+    dd.q[1] = symm_eigenvector_near(a, dd.q[0], l[1]);
+    dd.q[2] = cross(dd.q[0], dd.q[1]);
+    dd = polish_eigen_pair(a, dd, 1, 2);
+  }
+  dd.l = dd.l * s;
+  return dd;
+}
+
+OMEGA_H_INLINE DiagDecomp<2> decompose_eigen_symm(Matrix<2, 2> a) {
+  return decompose_eigen(a);
+}
+
+OMEGA_H_INLINE DiagDecomp<1> decompose_eigen_symm(Matrix<1, 1> a) {
+  return decompose_eigen(a);
+}
+
 template <Int dim>
 OMEGA_H_INLINE DiagDecomp<dim> sort_by_magnitude(DiagDecomp<dim> dd) {
   Few<Int, dim> perm;
@@ -447,6 +579,12 @@ OMEGA_H_INLINE DiagDecomp<dim> sort_by_magnitude(DiagDecomp<dim> dd) {
 }
 
 Reals get_max_eigenvalues(Int dim, Reals symms);
+/* the decompositions of an array of symmetric matrices,
+   see decompose_eigen_symm().
+   (eigenvalues) gets (dim) values and (eigenvectors) gets (dim * dim)
+   values per matrix, the latter in the layout of set_matrix() */
+void decompose_eigens(
+    Int dim, Reals symms, Reals* eigenvalues, Reals* eigenvectors);
 
 }  // end namespace Omega_h
 
@@ -1,9 +1,14 @@
 #include "Omega_h_ghost.hpp"
 
+#include <iostream>
+
+#include "Omega_h_array_ops.hpp"
 #include "Omega_h_loop.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_mesh.hpp"
 #include "Omega_h_migrate.hpp"
+#include "Omega_h_owners.hpp"
+#include "Omega_h_unmap_mesh.hpp"
 
 namespace Omega_h {
 
@@ -100,6 +105,7 @@ static Dist close_down(Mesh* mesh, Remotes old_use_owners, Dist elems2owners) {
 }
 
 void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose) {
+  begin_code("ghost_mesh");
   OMEGA_H_CHECK(mesh->nghost_layers() >= 0);
   OMEGA_H_CHECK(nlayers > mesh->nghost_layers());
   auto nnew_layers = nlayers - mesh->nghost_layers();
@@ -115,9 +121,11 @@ void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose) {
     elems2owners = close_up(mesh, own_verts2own_elems, verts2owners);
   }
   migrate_mesh(mesh, elems2owners, OMEGA_H_GHOSTED, verbose);
+  end_code();
 }
 
 void partition_by_verts(Mesh* mesh, bool verbose) {
+  begin_code("partition_by_verts");
   /* vertex-based partitioning is defined as gathering the elements
    * adjacent to owned vertices, hence the graph from owned vertices
    * to elements already contains what we need and we can skip push_elem_uses()
@@ -128,16 +136,84 @@ void partition_by_verts(Mesh* mesh, bool verbose) {
   auto elems2owners =
       get_new_copies2old_owners(uses2old_owners, old_owner_globals);
   migrate_mesh(mesh, elems2owners, OMEGA_H_VERT_BASED, verbose);
+  end_code();
+}
+
+/* mark the entities of dimension (low_dim) that are adjacent
+ * to at least one marked element on this MPI rank.
+ * unlike mark_down(), this does not communicate */
+static Read<I8> mark_closure_locally(
+    Mesh* mesh, Int low_dim, Read<I8> elems_are_marked) {
+  auto dim = mesh->dim();
+  if (low_dim == dim) return elems_are_marked;
+  auto l2e = mesh->ask_up(low_dim, dim);
+  auto l2le = l2e.a2ab;
+  auto le2e = l2e.ab2b;
+  auto nl = mesh->nents(low_dim);
+  Write<I8> low_marks(nl);
+  auto f = OMEGA_H_LAMBDA(LO l) {
+    I8 mark = 0;
+    for (auto le = l2le[l]; le < l2le[l + 1]; ++le) {
+      if (elems_are_marked[le2e[le]]) mark = 1;
+    }
+    low_marks[l] = mark;
+  };
+  parallel_for(nl, f, "mark_closure_locally");
+  return low_marks;
 }
 
+/* every element owned by this rank has its owner copy on this
+ * rank, whether the mesh is ghosted or vertex-based, and this holds
+ * even after set_owners_by_indset() reassigned cavity elements.
+ * so returning to an element-based partitioning amounts to
+ * dropping the copies we don't own along with their closure,
+ * and only the owners of lower-dimensional entities need to be
+ * renegotiated.
+ * this selects the same owners and entity order as migrating
+ * to the owned elements, without sending any entities or tags. */
 void partition_by_elems(Mesh* mesh, bool verbose) {
+  begin_code("partition_by_elems");
   auto dim = mesh->dim();
-  auto all2owners = mesh->ask_owners(dim);
-  auto marked_owned = mesh->owned(dim);
-  auto owned2all = collect_marked(marked_owned);
-  auto owned2owners = unmap(owned2all, all2owners);
-  auto dist = Dist(mesh->comm(), owned2owners, mesh->nelems());
-  migrate_mesh(mesh, dist, OMEGA_H_ELEM_BASED, verbose);
+  auto comm = mesh->comm();
+  auto elems_are_owned = mesh->owned(dim);
+  if (verbose) {
+    auto nowned = get_sum(elems_are_owned);
+    auto ndropped = GO(mesh->nelems() - nowned);
+    auto total_dropped = comm->allreduce(ndropped, OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "unghosting locally, dropping " << total_dropped
+                << " element copies\n";
+    }
+  }
+  auto new_mesh = mesh->copy_meta();
+  LOs old_lows2new_lows;
+  for (Int ent_dim = VERT; ent_dim <= dim; ++ent_dim) {
+    auto ents_are_kept = mark_closure_locally(mesh, ent_dim, elems_are_owned);
+    auto new_ents2old_ents = collect_marked(ents_are_kept);
+    auto nnew_ents = new_ents2old_ents.size();
+    if (ent_dim == VERT) {
+      new_mesh.set_verts(nnew_ents);
+    } else {
+      unmap_down(
+          mesh, &new_mesh, ent_dim, new_ents2old_ents, old_lows2new_lows);
+    }
+    unmap_tags(mesh, &new_mesh, ent_dim, new_ents2old_ents);
+    Remotes new_owners;
+    if (ent_dim == dim) {
+      new_owners =
+          Remotes(Read<I32>(nnew_ents, comm->rank()), LOs(nnew_ents, 0, 1));
+    } else {
+      auto old_owners = mesh->ask_owners(ent_dim);
+      auto new_ents2old_owners = unmap(new_ents2old_ents, old_owners);
+      auto dist = Dist(comm, new_ents2old_owners, mesh->nents(ent_dim));
+      new_owners = update_ownership(dist, Read<I32>());
+    }
+    new_mesh.set_owners(ent_dim, new_owners);
+    old_lows2new_lows =
+        invert_injective_map(new_ents2old_ents, mesh->nents(ent_dim));
+  }
+  *mesh = new_mesh;
+  end_code();
 }
 
 }  // end namespace Omega_h
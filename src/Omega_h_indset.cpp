@@ -46,6 +46,7 @@ struct Tuple {
 
 GOs find_indset(Graph graph, Int distance, Bytes candidates, Reals qualities,
     GOs globals, Dist owners2copies) {
+  begin_code("find_indset");
   auto comm = owners2copies.parent_comm();
   auto n = candidates.size();
   auto is_distributed = comm->size() > 1;
@@ -84,9 +85,11 @@ GOs find_indset(Graph graph, Int distance, Bytes candidates, Reals qualities,
       tuples.qualities = new_qualities;
       tuples.globals = new_globals;
       if (is_distributed) {
-        tuples.marks = owners2copies.exch(tuples.marks, 1);
-        tuples.qualities = owners2copies.exch(tuples.qualities, 1);
-        tuples.globals = owners2copies.exch(tuples.globals, 1);
+        ExchBatch batch;
+        batch.add(&tuples.marks, 1);
+        batch.add(&tuples.qualities, 1);
+        batch.add(&tuples.globals, 1);
+        batch.exch(owners2copies);
       }
     }
     Write<I8> new_marks(n);
@@ -109,6 +112,7 @@ GOs find_indset(Graph graph, Int distance, Bytes candidates, Reals qualities,
     marks = new_marks;
     if (is_distributed) marks = owners2copies.exch(marks, 1);
   }
+  end_code();
   return owner_globals;
 }
 
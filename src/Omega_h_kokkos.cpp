@@ -1,19 +1,32 @@
 #include "Omega_h_kokkos.hpp"
 
+#include <vector>
+
+#include "Omega_h_control.hpp"
+
 namespace Omega_h {
 
+static thread_local std::vector<std::string> code_stack;
+
 void begin_code(std::string const& name) {
 #ifdef OMEGA_H_USE_KOKKOSCORE
   Kokkos::Profiling::pushRegion(name);
-#else
-  (void)name;
 #endif
+  if (should_count_comm) code_stack.push_back(name);
 }
 
 void end_code() {
 #ifdef OMEGA_H_USE_KOKKOSCORE
   Kokkos::Profiling::popRegion();
 #endif
+  if (!code_stack.empty()) code_stack.pop_back();
+}
+
+std::string current_code() {
+  for (auto it = code_stack.rbegin(); it != code_stack.rend(); ++it) {
+    if (!it->empty()) return *it;
+  }
+  return "other";
 }
 
 }  // namespace Omega_h
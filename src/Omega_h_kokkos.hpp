@@ -48,6 +48,10 @@ OMEGA_H_SYSTEM_HEADER
 namespace Omega_h {
 void begin_code(std::string const& name = "");
 void end_code();
+/* the innermost named region of this thread, or "other".
+   regions are only tracked while communication is being counted,
+   see --osh-time */
+std::string current_code();
 }  // namespace Omega_h
 
 #endif
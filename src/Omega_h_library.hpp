@@ -2,11 +2,24 @@
 #define OMEGA_H_LIBRARY_HPP
 
 #include <map>
+#include <string>
+#include <utility>
 
 #include <Omega_h_comm.hpp>
 
 namespace Omega_h {
 
+/* communication charged to one call site, see Library::add_comm_stats */
+struct CommStats {
+  CommStats();  // zeroes everything
+  I64 ncalls;
+  I64 nmessages;
+  I64 nneighbors;
+  I64 nsent_bytes;
+  I64 nrecvd_bytes;
+  Real time;
+};
+
 class Library {
  public:
   Library(Library const&);
@@ -30,9 +43,29 @@ class Library {
   CommPtr self();
   void add_to_timer(std::string const& name, double nsecs);
   LO self_send_threshold() const;
+  /* with --osh-compress, Comm::alltoallv sends messages of at least
+     this many bytes compressed. zero means never */
+  LO compress_threshold() const;
+  /* reductions (Comm::allreduce, Comm::add_int128) first combine the
+     ranks of each node, then the node leaders, see --osh-node-aware.
+     ranks_per_node() is zero unless nodes are emulated by blocks of
+     consecutive ranks (--osh-ranks-per-node) */
+  bool node_aware() const;
+  Int ranks_per_node() const;
+  void add_migrated_bytes(I64 nbytes);
+  I64 migrated_bytes() const;
+  /* with --osh-time or --osh-comm-json, Comm charges each call to the
+     innermost begin_code region (see current_code). the counts are
+     summed over ranks, and printed or written as JSON by rank 0
+     when the Library is destroyed */
+  void add_comm_stats(
+      std::string const& site, std::string const& op, CommStats const& stats);
   bool should_time_;
   LO self_send_threshold_;
+  LO compress_threshold_;
   bool silent_;
+  bool node_aware_;
+  Int ranks_per_node_;
 
  private:
   void initialize(char const* head_desc, int* argc, char*** argv
@@ -50,6 +83,10 @@ class Library {
   bool we_called_kokkos_init;
 #endif
   std::map<std::string, double> timers;
+  I64 migrated_bytes_;
+  std::map<std::pair<std::string, std::string>, CommStats> comm_stats_;
+  std::string comm_json_path_;
+  void report_comm_stats();
 };
 
 }  // namespace Omega_h
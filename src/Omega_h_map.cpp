@@ -193,6 +193,49 @@ Graph invert_map_by_atomics(LOs a2b, LO nb) {
   return Graph(b2ba, ba2a);
 }
 
+/* the number of contiguous blocks of (a) counted in parallel.
+   a block holds a fixed number of entries, but no fewer than (4 nb),
+   so that the histograms of all blocks hold at most (na / 4 + nb)
+   entries. the thread count plays no part, and neither the
+   number of blocks nor their size changes the result */
+static LO count_blocks(LO na, LO nb) {
+  constexpr LO min_block_size = 256;
+  auto block_size = max2(min_block_size, 4 * nb);
+  return max2(LO(1), (na + block_size - 1) / block_size);
+}
+
+/* a stable counting sort: each block histograms its own (a).
+   the histograms are stored (b)-major, so a single scan over them
+   gives each block its first slot in (ba2a) for each (b), after
+   which each block places its (a) in its own slots */
+Graph invert_map_by_counting(LOs a2b, LO nb) {
+  auto na = a2b.size();
+  auto nblocks = count_blocks(na, nb);
+  auto block_size = (na + nblocks - 1) / nblocks;
+  Write<LO> counts(nb * nblocks, 0);
+  auto count = OMEGA_H_LAMBDA(LO block) {
+    auto end = min2(na, (block + 1) * block_size);
+    for (LO a = block * block_size; a < end; ++a) {
+      ++counts[a2b[a] * nblocks + block];
+    }
+  };
+  parallel_for(nblocks, count, "invert_map_by_counting(count)");
+  auto slots = offset_scan(Read<LO>(counts));
+  Write<LO> b2ba(nb + 1);
+  auto first = OMEGA_H_LAMBDA(LO b) { b2ba[b] = slots[b * nblocks]; };
+  parallel_for(nb + 1, first, "invert_map_by_counting(first)");
+  auto positions = deep_copy(slots);
+  Write<LO> ba2a(na);
+  auto fill = OMEGA_H_LAMBDA(LO block) {
+    auto end = min2(na, (block + 1) * block_size);
+    for (LO a = block * block_size; a < end; ++a) {
+      ba2a[positions[a2b[a] * nblocks + block]++] = a;
+    }
+  };
+  parallel_for(nblocks, fill, "invert_map_by_counting(fill)");
+  return Graph(LOs(b2ba), LOs(ba2a));
+}
+
 LOs get_degrees(LOs offsets) {
   Write<LO> degrees(offsets.size() - 1);
   auto f = OMEGA_H_LAMBDA(LO i) { degrees[i] = offsets[i + 1] - offsets[i]; };
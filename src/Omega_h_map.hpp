@@ -44,6 +44,10 @@ Graph invert_map_by_sorting(LOs a2b, LO nb);
 
 Graph invert_map_by_atomics(LOs a2b, LO nb);
 
+/* like invert_map_by_atomics(), but each (b) lists its (a)
+   in increasing order, so the result is the same on every run */
+Graph invert_map_by_counting(LOs a2b, LO nb);
+
 LOs get_degrees(LOs offsets);
 
 LOs invert_fan(LOs a2b);
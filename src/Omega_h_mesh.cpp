@@ -53,8 +53,11 @@ void Mesh::set_comm(CommPtr const& new_comm) {
   }
   /* if some ranks already have mesh data, their
      parallel info needs updating, we'll do this
-     by using the old Dist to set new owners */
-  if (0 < nnew_had_comm && library_->world()->size() > 1) {
+     by using the old Dist to set new owners.
+     ranks on threads (see run_on_threads) have a world of size one */
+  if (0 < nnew_had_comm &&
+      (library_->world()->size() > 1 || comm_->size() > 1 ||
+          new_comm->size() > 1)) {
     for (Int d = 0; d <= dim(); ++d) {
       auto dist = ask_dist(d);
       dist.change_comm(new_comm);
@@ -99,12 +102,13 @@ LO Mesh::nedges() const { return nents(EDGE); }
 
 LO Mesh::nverts() const { return nents(VERT); }
 
+LO Mesh::nents_owned(Int dim) {
+  if (!could_be_shared(dim)) return nents(dim);
+  return get_sum(this->owned(dim));
+}
+
 GO Mesh::nglobal_ents(Int dim) {
-  if (!could_be_shared(dim)) {
-    return comm_->allreduce(GO(nents(dim)), OMEGA_H_SUM);
-  }
-  auto nowned = get_sum(this->owned(dim));
-  return comm_->allreduce(GO(nowned), OMEGA_H_SUM);
+  return comm_->allreduce(GO(nents_owned(dim)), OMEGA_H_SUM);
 }
 
 template <typename T>
@@ -153,6 +157,10 @@ void Mesh::react_to_set_tag(Int dim, std::string const& name) {
     remove_tag(EDGE, "length");
     remove_tag(this->dim(), "quality");
   }
+  if ((dim == VERT) && (name == "metric")) {
+    remove_tag(VERT, "log_metric");
+    remove_tag(EDGE, "mident_metric");
+  }
   if ((dim == VERT) && (name == "coordinates")) {
     remove_tag(this->dim(), "size");
   }
@@ -469,6 +477,7 @@ void Mesh::set_parting(Omega_h_Parting parting, bool verbose) {
    modifies the RIB hints */
 void Mesh::balance(bool predictive) {
   if (comm_->size() == 1) return;
+  begin_code("Mesh::balance");
   set_parting(OMEGA_H_ELEM_BASED);
   inertia::Rib hints;
   if (rib_hints_) hints = *rib_hints_;
@@ -499,6 +508,7 @@ void Mesh::balance(bool predictive) {
   owners2new.set_dest_globals(owner_globals);
   auto sorted_new2owners = owners2new.invert();
   migrate_mesh(this, sorted_new2owners, OMEGA_H_ELEM_BASED, false);
+  end_code();
 }
 
 Graph Mesh::ask_graph(Int from, Int to) {
@@ -36,6 +36,8 @@ class Mesh {
   LO ntris() const;
   LO nedges() const;
   LO nverts() const;
+  /* the entities this rank owns, whose sum is nglobal_ents(dim) */
+  LO nents_owned(Int dim);
   GO nglobal_ents(Int dim);
   template <typename T>
   void add_tag(Int dim, std::string const& name, Int ncomps);
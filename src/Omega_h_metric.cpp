@@ -5,6 +5,7 @@
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_host_few.hpp"
 #include "Omega_h_loop.hpp"
+#include "Omega_h_map.hpp"
 #include "Omega_h_recover.hpp"
 #include "Omega_h_shape.hpp"
 #include "Omega_h_simplex.hpp"
@@ -96,6 +97,40 @@ Reals get_mident_metrics(Mesh* mesh, Int ent_dim, Reals v2m) {
   return get_mident_metrics(mesh, ent_dim, e2e, v2m);
 }
 
+void add_log_metric_tag(Mesh* mesh) {
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  auto ncomps = mesh->get_tagbase(VERT, "metric")->ncomps();
+  auto log_metrics = linearize_metrics(mesh->nverts(), metrics);
+  mesh->remove_tag(VERT, "log_metric");
+  mesh->add_tag(VERT, "log_metric", ncomps, log_metrics, true);
+}
+
+void add_mident_metric_tag(Mesh* mesh) {
+  auto ncomps = mesh->get_tagbase(VERT, "metric")->ncomps();
+  mesh->remove_tag(EDGE, "mident_metric");
+  auto mident_metrics =
+      get_mident_metrics(mesh, EDGE, LOs(mesh->nedges(), 0, 1));
+  mesh->add_tag(EDGE, "mident_metric", ncomps, mident_metrics, true);
+}
+
+Reals get_mident_metrics(Mesh* mesh, Int ent_dim, LOs entities) {
+  if (ent_dim == EDGE && mesh->has_tag(EDGE, "mident_metric")) {
+    auto ncomps = mesh->get_tagbase(EDGE, "mident_metric")->ncomps();
+    return unmap(
+        entities, mesh->get_array<Real>(EDGE, "mident_metric"), ncomps);
+  }
+  if (!mesh->has_tag(VERT, "log_metric")) {
+    return get_mident_metrics(
+        mesh, ent_dim, entities, mesh->get_array<Real>(VERT, "metric"));
+  }
+  if (entities.size() == 0) return Reals({});
+  auto ncomps = mesh->get_tagbase(VERT, "log_metric")->ncomps();
+  auto log_metrics = mesh->get_array<Real>(VERT, "log_metric");
+  auto mident_logs =
+      average_field(mesh, ent_dim, entities, ncomps, log_metrics);
+  return delinearize_metrics(entities.size(), mident_logs);
+}
+
 Reals interpolate_between_metrics(LO nmetrics, Reals a, Reals b, Real t) {
   auto log_a = linearize_metrics(nmetrics, a);
   auto log_b = linearize_metrics(nmetrics, b);
@@ -179,15 +214,30 @@ void axes_from_metric_field(Mesh* mesh, std::string const& metric_name,
   OMEGA_H_NORETURN();
 }
 
-/* gradation limiting code: */
+/* gradation limiting code:
+   the limiter is a Jacobi iteration, but a vertex whose own value and
+   whose neighbors' values did not change in the previous step would
+   compute exactly the same value again.
+   so each step only updates the vertices in or next to the set
+   that changed (bitwise) in the step before, which gives the same result
+   as updating all of them while the work follows the front of the
+   region that is still changing.
+   a step reads one buffer and writes its active vertices into the other,
+   then copies the ones that changed back, so the two buffers agree
+   again. what remains proportional to the mesh per step is clearing
+   and scanning byte marks.
+   on a distributed mesh, owners compute the active vertices and send
+   those that changed to their copies, so the front crosses ranks.
+   vertices with copies on other ranks are computed first, and the
+   interior ones while their values are in flight */
 
 template <Int mesh_dim, Int metric_dim>
-static Reals limit_gradation_once_tmpl(
-    Mesh* mesh, Reals values, Real max_rate) {
+static void limit_gradation_once_tmpl(Mesh* mesh, Reals values,
+    Write<Real> out, Real max_rate, LOs active2verts) {
   auto v2v = mesh->ask_star(VERT);
   auto coords = mesh->coords();
-  auto out = Write<Real>(mesh->nverts() * symm_ncomps(metric_dim));
-  auto f = OMEGA_H_LAMBDA(LO v) {
+  auto f = OMEGA_H_LAMBDA(LO active) {
+    auto v = active2verts[active];
     auto m = get_symm<metric_dim>(values, v);
     auto x = get_vector<mesh_dim>(coords, v);
     for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
@@ -203,47 +253,146 @@ static Reals limit_gradation_once_tmpl(
     }
     set_symm(out, v, m);
   };
-  parallel_for(mesh->nverts(), f, "limit_metric_gradation");
-  values = Reals(out);
-  values = mesh->sync_array(VERT, values, symm_ncomps(metric_dim));
-  return values;
+  parallel_for(active2verts.size(), f, "limit_metric_gradation");
 }
 
-static Reals limit_gradation_once(Mesh* mesh, Reals values, Real max_rate) {
+static void limit_gradation_once(Mesh* mesh, Reals values, Write<Real> out,
+    Real max_rate, LOs active2verts) {
   auto metric_dim = get_metrics_dim(mesh->nverts(), values);
   if (mesh->dim() == 3 && metric_dim == 3) {
-    return limit_gradation_once_tmpl<3, 3>(mesh, values, max_rate);
+    limit_gradation_once_tmpl<3, 3>(
+        mesh, values, out, max_rate, active2verts);
   } else if (mesh->dim() == 2 && metric_dim == 2) {
-    return limit_gradation_once_tmpl<2, 2>(mesh, values, max_rate);
+    limit_gradation_once_tmpl<2, 2>(
+        mesh, values, out, max_rate, active2verts);
   } else if (mesh->dim() == 3 && metric_dim == 1) {
-    return limit_gradation_once_tmpl<3, 1>(mesh, values, max_rate);
+    limit_gradation_once_tmpl<3, 1>(
+        mesh, values, out, max_rate, active2verts);
   } else if (mesh->dim() == 2 && metric_dim == 1) {
-    return limit_gradation_once_tmpl<2, 1>(mesh, values, max_rate);
+    limit_gradation_once_tmpl<2, 1>(
+        mesh, values, out, max_rate, active2verts);
   } else if (mesh->dim() == 1) {
-    return limit_gradation_once_tmpl<1, 1>(mesh, values, max_rate);
+    limit_gradation_once_tmpl<1, 1>(
+        mesh, values, out, max_rate, active2verts);
+  } else {
+    OMEGA_H_NORETURN();
   }
-  OMEGA_H_NORETURN(Reals());
 }
 
-Reals limit_metric_gradation(
-    Mesh* mesh, Reals values, Real max_rate, Real tol, bool verbose) {
+/* marks the vertices of (cands2verts) at which (old_values) and
+   (new_values) differ */
+static void mark_changed_verts(Reals old_values, Reals new_values,
+    LOs cands2verts, Write<I8> changed) {
+  auto ncomps = divide_no_remainder(old_values.size(), changed.size());
+  auto f = OMEGA_H_LAMBDA(LO cand) {
+    auto v = cands2verts[cand];
+    for (Int i = 0; i < ncomps; ++i) {
+      if (old_values[v * ncomps + i] != new_values[v * ncomps + i]) {
+        changed[v] = 1;
+      }
+    }
+  };
+  parallel_for(cands2verts.size(), f, "mark_changed_verts");
+}
+
+/* returns the vertices marked in (changed).
+   (*p_front) marks them and their neighbors. */
+static LOs find_gradation_front(
+    Mesh* mesh, Read<I8> changed, Read<I8>* p_front) {
+  auto changed2verts = collect_marked(changed);
+  auto v2v = mesh->ask_star(VERT);
+  Write<I8> front(mesh->nverts(), 0);
+  /* concurrent writes here all store the same value */
+  auto f = OMEGA_H_LAMBDA(LO changed_vert) {
+    auto v = changed2verts[changed_vert];
+    front[v] = 1;
+    for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
+      front[v2v.ab2b[vv]] = 1;
+    }
+  };
+  parallel_for(changed2verts.size(), f, "find_gradation_front");
+  *p_front = front;
+  return changed2verts;
+}
+
+/* splits the owned vertices of (active2verts) into those
+   with copies on other ranks and the rest */
+static void split_gradation_active(LOs active2verts, Read<I8> verts_are_owned,
+    Read<I8> verts_are_shared, LOs* p_shared2verts, LOs* p_interior2verts) {
+  auto active_is_owned = unmap(active2verts, verts_are_owned, 1);
+  auto active_is_shared = unmap(active2verts, verts_are_shared, 1);
+  auto active_is_interior =
+      land_each(active_is_owned, invert_marks(active_is_shared));
+  *p_shared2verts = unmap(collect_marked(active_is_shared), active2verts, 1);
+  *p_interior2verts =
+      unmap(collect_marked(active_is_interior), active2verts, 1);
+}
+
+Reals limit_metric_gradation(Mesh* mesh, Reals values, Real max_rate,
+    Real tol, bool verbose, GO* p_nupdates) {
   OMEGA_H_CHECK(mesh->owners_have_all_upward(VERT));
   OMEGA_H_CHECK(max_rate > 0.0);
   auto comm = mesh->comm();
-  Reals values2 = values;
+  auto nverts = mesh->nverts();
+  auto ncomps = divide_no_remainder(values.size(), nverts);
+  auto is_distributed = mesh->could_be_shared(VERT);
+  auto verts_are_owned = mesh->owned(VERT);
+  /* owned vertices with copies on other ranks. each
+     vertex of this Dist sends to itself as well as to its copies */
+  Dist owners2copies;
+  Read<I8> verts_are_shared(nverts, 0);
+  if (is_distributed) {
+    owners2copies = mesh->ask_dist(VERT).invert();
+    verts_are_shared = each_gt(get_degrees(owners2copies.roots2items()), 1);
+  }
+  auto active2verts = LOs(nverts, 0, 1);
+  Write<Real> older = deep_copy(values);
+  Write<Real> newer = deep_copy(values);
+  GO nupdates = 0;
   Int i = 0;
+  bool done;
   do {
-    values = values2;
-    values2 = limit_gradation_once(mesh, values, max_rate);
+    LOs shared2verts, interior2verts;
+    split_gradation_active(active2verts, verts_are_owned, verts_are_shared,
+        &shared2verts, &interior2verts);
+    nupdates += shared2verts.size() + interior2verts.size();
+    Write<I8> changed(nverts, 0);
+    limit_gradation_once(mesh, older, newer, max_rate, shared2verts);
+    Future<Real> recvd_values;
+    Future<LO> recvd2verts;
+    if (is_distributed) {
+      mark_changed_verts(older, newer, shared2verts, changed);
+      recvd_values = owners2copies.exch_subset_begin(
+          Read<I8>(changed), Reals(newer), ncomps, &recvd2verts);
+    }
+    limit_gradation_once(mesh, older, newer, max_rate, interior2verts);
+    mark_changed_verts(older, newer, interior2verts, changed);
+    if (is_distributed) {
+      auto recvd2verts_done = recvd2verts.get();
+      map_into(recvd_values.get(), recvd2verts_done, newer, ncomps);
+      mark_changed_verts(older, newer, recvd2verts_done, changed);
+    }
     ++i;
     if (verbose && can_print(mesh) && i > 40) {
       std::cout << "warning: gradation limiting is up to step " << i << '\n';
     }
-  } while (!comm->reduce_and(are_close(values, values2, tol)));
+    Read<I8> verts_are_active;
+    auto changed2verts =
+        find_gradation_front(mesh, changed, &verts_are_active);
+    auto old_changed = unmap(changed2verts, Reals(older), ncomps);
+    auto new_changed = unmap(changed2verts, Reals(newer), ncomps);
+    /* unchanged values are trivially close */
+    done = comm->reduce_and(are_close(old_changed, new_changed, tol));
+    map_into(new_changed, changed2verts, older, ncomps);
+    active2verts = collect_marked(verts_are_active);
+  } while (!done);
+  if (verbose || p_nupdates) nupdates = comm->allreduce(nupdates, OMEGA_H_SUM);
   if (verbose && can_print(mesh)) {
-    std::cout << "limited gradation in " << i << " steps\n";
+    std::cout << "limited gradation in " << i << " steps (" << nupdates
+              << " vertex updates)\n";
   }
-  return values2;
+  if (p_nupdates) *p_nupdates = nupdates;
+  return newer;
 }
 
 Reals project_metrics(Mesh* mesh, Reals e2m) {
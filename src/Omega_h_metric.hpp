@@ -16,6 +16,19 @@ metric_product(Matrix<1, 1> m, Vector<space_dim> v) {
   return v * (m[0][0] * v);
 }
 
+/* the gradient of metric_product(m, v) with respect to v */
+template <Int dim>
+OMEGA_H_INLINE Vector<dim> metric_product_gradient(
+    Matrix<dim, dim> m, Vector<dim> v) {
+  return 2.0 * (m * v);
+}
+
+template <Int space_dim>
+OMEGA_H_INLINE typename std::enable_if<(space_dim > 1), Vector<space_dim>>::type
+metric_product_gradient(Matrix<1, 1> m, Vector<space_dim> v) {
+  return (2.0 * m[0][0]) * v;
+}
+
 template <Int metric_dim, Int space_dim>
 OMEGA_H_INLINE Real metric_length(
     Matrix<metric_dim, metric_dim> m, Vector<space_dim> v) {
@@ -214,6 +227,18 @@ Int get_metric_dim(Mesh* mesh);
 
 Reals get_mident_metrics(Mesh* mesh, Int ent_dim, LOs entities, Reals v2m);
 Reals get_mident_metrics(Mesh* mesh, Int ent_dim, Reals v2m);
+/* the vertex tag "log_metric", when present, holds the linearized
+   form of the "metric" tag and is carried along by adaptation,
+   so that interpolation only needs to delinearize its results.
+   setting "metric" from outside of adaptation removes it. */
+void add_log_metric_tag(Mesh* mesh);
+/* the edge tag "mident_metric", when present, caches the edge
+   midpoint metrics. it is kept up to date for new edges by adaptation
+   and removed when the "metric" tag is set from outside of it. */
+void add_mident_metric_tag(Mesh* mesh);
+/* midpoint metrics of the "metric" tag, from "mident_metric"
+   or "log_metric" if present */
+Reals get_mident_metrics(Mesh* mesh, Int ent_dim, LOs entities);
 Reals interpolate_between_metrics(LO nmetrics, Reals a, Reals b, Real t);
 Reals linearize_metrics(LO nmetrics, Reals metrics);
 Reals delinearize_metrics(LO nmetrics, Reals linear_metrics);
@@ -227,8 +252,10 @@ Reals get_pure_implied_metrics(Mesh* mesh);
 Reals get_implied_metrics(Mesh* mesh);
 void axes_from_metric_field(
     Mesh* mesh, std::string const& metric_name, std::string const& axis_prefix);
+/* if (nupdates) is given, it receives the global number of
+   vertex updates the limiter needed */
 Reals limit_metric_gradation(Mesh* mesh, Reals values, Real max_rate,
-    Real tol = 1e-3, bool verbose = true);
+    Real tol = 1e-3, bool verbose = true, GO* nupdates = nullptr);
 Reals get_expected_nelems_per_elem(Mesh* mesh, Reals v2m);
 Real get_expected_nelems(Mesh* mesh, Reals v2m);
 Real get_metric_scalar_for_nelems(
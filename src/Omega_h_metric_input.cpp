@@ -1,11 +1,14 @@
 #include "Omega_h_adapt.hpp"
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_control.hpp"
+#include "Omega_h_loop.hpp"
+#include "Omega_h_map.hpp"
 #include "Omega_h_mesh.hpp"
 #include "Omega_h_metric.hpp"
 #include "Omega_h_recover.hpp"
 #include "Omega_h_timer.hpp"
 
+#include <cmath>
 #include <iostream>
 
 namespace Omega_h {
@@ -31,6 +34,7 @@ MetricInput::MetricInput() {
   max_element_count = 1e6;
   min_element_count = 1.0;
   element_count_over_relaxation = 1.1;
+  should_scale_element_count_in_closed_form = false;
   nsmoothing_steps = 0;
 }
 
@@ -133,7 +137,223 @@ Reals get_derivative_metrics(Mesh* mesh, std::string const& name, Real knob) {
   return get_hessian_metrics(dim, data, knob);
 }
 
-Reals generate_metrics(Mesh* mesh, MetricInput const& input) {
+/* intersects the sources, the scaled ones being multiplied by
+   (scalar) first, and smooths the result */
+static Reals compose_metrics(Mesh* mesh, MetricInput const& input,
+    std::vector<Reals> const& original_metrics, Int metric_dim, Real scalar) {
+  auto n = mesh->nverts();
+  Reals metrics;
+  for (size_t i = 0; i < input.sources.size(); ++i) {
+    auto in_metrics = original_metrics[i];
+    if (get_metrics_dim(n, in_metrics) == 1) {
+      in_metrics = metrics_from_isos(metric_dim, in_metrics);
+    }
+    if (input.sources[i].scales == OMEGA_H_SCALES) {
+      in_metrics = multiply_each_by(scalar, in_metrics);
+    }
+    if (input.should_limit_lengths) {
+      in_metrics =
+          clamp_metrics(n, in_metrics, input.min_length, input.max_length);
+    }
+    if (i) {
+      metrics = intersect_metrics(n, metrics, in_metrics);
+    } else {
+      metrics = in_metrics;
+    }
+  }
+  for (Int i = 0; i < input.nsmoothing_steps; ++i) {
+    metrics = smooth_metric_once(mesh, metrics);
+  }
+  return metrics;
+}
+
+/* the gradation limiter bounds the length at each vertex (x) by
+   (h(y) + rate * d(x, y)) over all vertices (y), with (d) the length
+   of the shortest edge path between them. scaling the metrics by (s)
+   scales (h) by (1 / sqrt(s)) but not (d), which is why the limited
+   element count does not scale like the unlimited one.
+   this finds, for the isotropic lengths (h) of the field scaled by
+   (guess), the length (h(y)) and distance (d(x, y)) of the bounding
+   vertex (y) of each vertex, after which the limited lengths at any
+   scalar near (guess) are a pointwise expression */
+template <Int dim>
+static void find_gradation_sources_tmpl(Mesh* mesh, Reals lengths,
+    Real max_rate, Real guess, Reals* p_src_lengths, Reals* p_src_dists) {
+  auto v2v = mesh->ask_star(VERT);
+  auto coords = mesh->coords();
+  auto comm = mesh->comm();
+  auto nverts = mesh->nverts();
+  auto rate = max_rate * std::sqrt(guess);
+  /* each vertex holds its source's (length, distance) pair, so that
+     one exchange synchronizes both */
+  Reals srcs =
+      interleave(std::vector<Read<Real>>({lengths, Reals(nverts, 0.0)}));
+  /* only vertices next to a change need to be looked at again */
+  auto active2verts = LOs(nverts, 0, 1);
+  while (comm->allreduce(GO(active2verts.size()), OMEGA_H_SUM)) {
+    auto old_srcs = srcs;
+    auto new_srcs = deep_copy(old_srcs);
+    Write<I8> are_changed(nverts, 0);
+    auto f = OMEGA_H_LAMBDA(LO active) {
+      auto v = active2verts[active];
+      auto h = old_srcs[v * 2 + 0];
+      auto d = old_srcs[v * 2 + 1];
+      auto x = get_vector<dim>(coords, v);
+      for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
+        auto av = v2v.ab2b[vv];
+        auto ax = get_vector<dim>(coords, av);
+        auto ah = old_srcs[av * 2 + 0];
+        auto ad = old_srcs[av * 2 + 1] + norm(ax - x);
+        if (ah + rate * ad < h + rate * d) {
+          h = ah;
+          d = ad;
+          are_changed[v] = 1;
+        }
+      }
+      new_srcs[v * 2 + 0] = h;
+      new_srcs[v * 2 + 1] = d;
+    };
+    parallel_for(active2verts.size(), f, "find_gradation_sources");
+    srcs = new_srcs;
+    if (mesh->could_be_shared(VERT)) {
+      /* copies may take their owner's change */
+      srcs = mesh->sync_array(VERT, srcs, 2);
+      auto g = OMEGA_H_LAMBDA(LO v) {
+        if (srcs[v * 2 + 0] != old_srcs[v * 2 + 0] ||
+            srcs[v * 2 + 1] != old_srcs[v * 2 + 1]) {
+          are_changed[v] = 1;
+        }
+      };
+      parallel_for(nverts, g, "find_gradation_sources(changed)");
+    }
+    auto changed2verts = collect_marked(Read<I8>(are_changed));
+    Write<I8> are_active(nverts, 0);
+    /* concurrent writes here all store the same value */
+    auto h = OMEGA_H_LAMBDA(LO changed) {
+      auto v = changed2verts[changed];
+      are_active[v] = 1;
+      for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
+        are_active[v2v.ab2b[vv]] = 1;
+      }
+    };
+    parallel_for(changed2verts.size(), h, "find_gradation_sources(front)");
+    active2verts = collect_marked(Read<I8>(are_active));
+  }
+  *p_src_lengths = get_component(srcs, 2, 0);
+  *p_src_dists = get_component(srcs, 2, 1);
+}
+
+static void find_gradation_sources(Mesh* mesh, Reals lengths, Real max_rate,
+    Real guess, Reals* p_src_lengths, Reals* p_src_dists) {
+  auto dim = mesh->dim();
+  if (dim == 3) {
+    find_gradation_sources_tmpl<3>(
+        mesh, lengths, max_rate, guess, p_src_lengths, p_src_dists);
+  } else if (dim == 2) {
+    find_gradation_sources_tmpl<2>(
+        mesh, lengths, max_rate, guess, p_src_lengths, p_src_dists);
+  } else {
+    find_gradation_sources_tmpl<1>(
+        mesh, lengths, max_rate, guess, p_src_lengths, p_src_dists);
+  }
+}
+
+static Reals get_iso_lengths(Mesh* mesh, Reals metrics) {
+  auto isos = apply_isotropy(mesh->nverts(), metrics, OMEGA_H_ISO_SIZE);
+  Write<Real> lengths(isos.size());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    lengths[v] = metric_length_from_eigenvalue(isos[v]);
+  };
+  parallel_for(isos.size(), f, "get_iso_lengths");
+  return lengths;
+}
+
+/* the closed-form alternative to iterating the whole pipeline.
+   given the expected element count (limited_nelems) of the limited
+   field at (base_scalar), the count at another scalar is modeled by
+   composing the sources at that scalar, reducing them to isotropic
+   lengths of the same size, and bounding those by the gradation
+   sources above, all of which is pointwise.
+   without gradation limiting, the model is just the composed field.
+   the gradation sources are exact only at the scalar they were found
+   for, and the model undercounts elsewhere, so they are found again
+   at each solution until it stops moving. the first ones are found at
+   (base_scalar), where they calibrate the model to the real count.
+   the model count is nearly linear in log-log space with slope
+   at most dim / 2, so a secant search starting from the power law
+   finds the scalar that hits (target_nelems). */
+static Real solve_element_count_scalar(Mesh* mesh, MetricInput const& input,
+    std::vector<Reals> const& original_metrics, Int metric_dim,
+    Real base_scalar, Real limited_nelems, Real target_nelems) {
+  /* the search ends once new gradation sources move the solution
+     by less than this relative amount. the model is the tangent of
+     the limited count at the sources' scalar, so the next move
+     would be much smaller still */
+  constexpr Real source_tolerance = 1e-1;
+  constexpr Int max_source_updates = 10;
+  auto dim = mesh->dim();
+  auto rate = input.max_gradation_rate;
+  Reals pre_lengths;
+  if (input.should_limit_gradation) {
+    auto pre_metrics =
+        compose_metrics(mesh, input, original_metrics, metric_dim, 1.0);
+    pre_lengths = get_iso_lengths(mesh, pre_metrics);
+  }
+  Reals src_lengths, src_dists;
+  auto model_nelems = [&](Real scalar) {
+    auto metrics =
+        compose_metrics(mesh, input, original_metrics, metric_dim, scalar);
+    if (!input.should_limit_gradation) {
+      return get_expected_nelems(mesh, metrics);
+    }
+    auto lengths = get_iso_lengths(mesh, metrics);
+    auto factor = 1.0 / std::sqrt(scalar);
+    Write<Real> isos(lengths.size());
+    auto f = OMEGA_H_LAMBDA(LO v) {
+      auto h = min2(lengths[v], src_lengths[v] * factor + rate * src_dists[v]);
+      isos[v] = metric_eigenvalue_from_length(h);
+    };
+    parallel_for(isos.size(), f, "element_count_model");
+    return get_expected_nelems(mesh, Reals(isos));
+  };
+  Real calibration = 1.0;
+  auto model = [&](Real scalar) {
+    return std::log(calibration * model_nelems(scalar) / target_nelems);
+  };
+  auto guess = base_scalar;
+  for (Int update = 0; true; ++update) {
+    if (input.should_limit_gradation) {
+      find_gradation_sources(
+          mesh, pre_lengths, rate, guess, &src_lengths, &src_dists);
+    }
+    /* the model is calibrated to the real count at (base_scalar) */
+    if (update == 0) calibration = limited_nelems / model_nelems(base_scalar);
+    Real x0 = std::log(base_scalar);
+    Real y0 = model(base_scalar);
+    Real x1 = x0 - y0 * 2.0 / dim;
+    Real y1 = model(std::exp(x1));
+    for (Int i = 0; std::abs(y1) > 1e-3; ++i) {
+      if (i == 100) {
+        Omega_h_fail("Too many element count model iterations\n");
+      }
+      auto slope = (y1 - y0) / (x1 - x0);
+      if (!(slope > 0.0)) slope = Real(dim) / 2.0;
+      x0 = x1;
+      y0 = y1;
+      x1 = x1 - y1 / slope;
+      y1 = model(std::exp(x1));
+    }
+    auto solution = std::exp(x1);
+    if (!input.should_limit_gradation ||
+        std::abs(std::log(solution / guess)) < source_tolerance ||
+        update + 1 == max_source_updates) {
+      return solution;
+    }
+    guess = solution;
+  }
+}
+
+Reals generate_metrics(Mesh* mesh, MetricInput const& input, Int* p_npasses) {
   auto t0 = now();
   if (input.should_limit_lengths) {
     OMEGA_H_CHECK(input.min_length <= input.max_length);
@@ -191,32 +411,13 @@ Reals generate_metrics(Mesh* mesh, MetricInput const& input) {
   Real scalar = 1.0;
   Reals metrics;
   Int niters;
+  constexpr Int max_closed_form_passes = 2;
   for (niters = 0; true; ++niters) {
     if (niters == 100) {
       Omega_h_fail("Too many element count limiting iterations\n");
     }
-    metrics = Reals();
-    for (size_t i = 0; i < input.sources.size(); ++i) {
-      auto in_metrics = original_metrics[i];
-      if (get_metrics_dim(n, in_metrics) == 1) {
-        in_metrics = metrics_from_isos(metric_dim, in_metrics);
-      }
-      if (input.sources[i].scales == OMEGA_H_SCALES) {
-        in_metrics = multiply_each_by(scalar, in_metrics);
-      }
-      if (input.should_limit_lengths) {
-        in_metrics =
-            clamp_metrics(n, in_metrics, input.min_length, input.max_length);
-      }
-      if (i) {
-        metrics = intersect_metrics(n, metrics, in_metrics);
-      } else {
-        metrics = in_metrics;
-      }
-    }
-    for (Int i = 0; i < input.nsmoothing_steps; ++i) {
-      metrics = smooth_metric_once(mesh, metrics);
-    }
+    metrics =
+        compose_metrics(mesh, input, original_metrics, metric_dim, scalar);
     if (input.should_limit_gradation) {
       metrics = limit_metric_gradation(mesh, metrics, input.max_gradation_rate,
           input.gradation_convergence_tolerance, input.verbose);
@@ -225,7 +426,28 @@ Reals generate_metrics(Mesh* mesh, MetricInput const& input) {
       break;
     } else {
       auto nelems = get_expected_nelems(mesh, metrics);
-      if (nelems > input.max_element_count) {
+      /* in the closed-form mode, the correction comes from the model,
+         calibrated at the first limited field, and the second field
+         is kept even if it still misses the range, rather than
+         iterating as the regular mode does */
+      auto is_closed_form = input.should_scale_element_count_in_closed_form;
+      if (is_closed_form && niters == max_closed_form_passes - 1) {
+        if (input.verbose && mesh->comm()->rank() == 0 &&
+            (nelems > input.max_element_count ||
+                nelems < input.min_element_count)) {
+          std::cout << "warning: closed-form element count scaling ends at "
+                    << nelems << " expected elements\n";
+        }
+        break;
+      } else if (is_closed_form && nelems > input.max_element_count) {
+        scalar = solve_element_count_scalar(mesh, input, original_metrics,
+            metric_dim, scalar, nelems, input.max_element_count);
+        scalar /= input.element_count_over_relaxation;
+      } else if (is_closed_form && nelems < input.min_element_count) {
+        scalar = solve_element_count_scalar(mesh, input, original_metrics,
+            metric_dim, scalar, nelems, input.min_element_count);
+        scalar *= input.element_count_over_relaxation;
+      } else if (nelems > input.max_element_count) {
         scalar *= get_metric_scalar_for_nelems(
             mesh->dim(), nelems, input.max_element_count);
         scalar /= input.element_count_over_relaxation;
@@ -238,6 +460,7 @@ Reals generate_metrics(Mesh* mesh, MetricInput const& input) {
       }
     }
   }
+  if (p_npasses) *p_npasses = niters + 1;
   auto t1 = now();
   add_to_global_timer("generating metrics", t1 - t0);
   if (input.verbose && mesh->comm()->rank() == 0) {
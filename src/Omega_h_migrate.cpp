@@ -123,26 +123,57 @@ void push_down(Mesh* old_mesh, Int ent_dim, Int low_dim,
 void push_tags(Mesh const* old_mesh, Mesh* new_mesh, Int ent_dim,
     Dist old_owners2new_ents) {
   OMEGA_H_CHECK(old_owners2new_ents.nroots() == old_mesh->nents(ent_dim));
-  for (Int i = 0; i < old_mesh->ntags(ent_dim); ++i) {
+  /* all tags travel together, the vectors are sized up front
+     so that the batch may keep pointers into them */
+  auto ntags = old_mesh->ntags(ent_dim);
+  std::vector<Read<I8>> i8_arrays(ntags);
+  std::vector<Read<I32>> i32_arrays(ntags);
+  std::vector<Read<I64>> i64_arrays(ntags);
+  std::vector<Read<Real>> real_arrays(ntags);
+  ExchBatch batch;
+  for (Int i = 0; i < ntags; ++i) {
     auto tag = old_mesh->get_tag(ent_dim, i);
     if (is<I8>(tag)) {
-      auto array = as<I8>(tag)->array();
-      array = old_owners2new_ents.exch(array, tag->ncomps());
+      i8_arrays[i] = as<I8>(tag)->array();
+      batch.add(&i8_arrays[i], tag->ncomps());
+    } else if (is<I32>(tag)) {
+      i32_arrays[i] = as<I32>(tag)->array();
+      batch.add(&i32_arrays[i], tag->ncomps());
+    } else if (is<I64>(tag)) {
+      i64_arrays[i] = as<I64>(tag)->array();
+      batch.add(&i64_arrays[i], tag->ncomps());
+    } else if (is<Real>(tag)) {
+      real_arrays[i] = as<Real>(tag)->array();
+      batch.add(&real_arrays[i], tag->ncomps());
+    }
+  }
+  batch.exch(old_owners2new_ents);
+  /* only entities that change ranks count as migrated */
+  auto items2ranks = old_owners2new_ents.items2ranks();
+  auto rank = old_owners2new_ents.parent_comm()->rank();
+  auto nremote = I64(get_sum(each_neq_to(items2ranks, rank)));
+  I64 nbytes = 0;
+  for (Int i = 0; i < ntags; ++i) {
+    auto tag = old_mesh->get_tag(ent_dim, i);
+    if (is<I8>(tag)) {
+      auto array = i8_arrays[i];
+      nbytes += nremote * tag->ncomps() * I64(sizeof(I8));
       new_mesh->add_tag<I8>(ent_dim, tag->name(), tag->ncomps(), array, true);
     } else if (is<I32>(tag)) {
-      auto array = as<I32>(tag)->array();
-      array = old_owners2new_ents.exch(array, tag->ncomps());
+      auto array = i32_arrays[i];
+      nbytes += nremote * tag->ncomps() * I64(sizeof(I32));
       new_mesh->add_tag<I32>(ent_dim, tag->name(), tag->ncomps(), array, true);
     } else if (is<I64>(tag)) {
-      auto array = as<I64>(tag)->array();
-      array = old_owners2new_ents.exch(array, tag->ncomps());
+      auto array = i64_arrays[i];
+      nbytes += nremote * tag->ncomps() * I64(sizeof(I64));
       new_mesh->add_tag<I64>(ent_dim, tag->name(), tag->ncomps(), array, true);
     } else if (is<Real>(tag)) {
-      auto array = as<Real>(tag)->array();
-      array = old_owners2new_ents.exch(array, tag->ncomps());
+      auto array = real_arrays[i];
+      nbytes += nremote * tag->ncomps() * I64(sizeof(Real));
       new_mesh->add_tag<Real>(ent_dim, tag->name(), tag->ncomps(), array, true);
     }
   }
+  old_mesh->library()->add_migrated_bytes(nbytes);
 }
 
 void push_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
@@ -189,6 +220,7 @@ static void print_migrate_stats(CommPtr comm, Dist new_elems2old_owners) {
 
 void migrate_mesh(
     Mesh* mesh, Dist new_elems2old_owners, Omega_h_Parting mode, bool verbose) {
+  begin_code("migrate_mesh");
   for (Int d = 0; d <= mesh->dim(); ++d) {
     OMEGA_H_CHECK(mesh->has_tag(d, "global"));
   }
@@ -218,6 +250,7 @@ void migrate_mesh(
   for (Int d = 0; d <= mesh->dim(); ++d) {
     OMEGA_H_CHECK(mesh->has_tag(d, "global"));
   }
+  end_code();
 }
 
 }  // end namespace Omega_h
@@ -2,7 +2,6 @@
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_indset.hpp"
 #include "Omega_h_map.hpp"
-#include "Omega_h_modify.hpp"
 #include "Omega_h_transfer.hpp"
 
 #include <iostream>
@@ -20,26 +19,57 @@ static bool move_verts_ghosted(Mesh* mesh, AdaptOpts const& opts) {
   auto choices = get_motion_choices(mesh, opts, cands2verts);
   verts_are_cands =
       map_onto(choices.cands_did_move, cands2verts, mesh->nverts(), I8(0), 1);
-  if (get_sum(comm, verts_are_cands) == 0) return false;
   auto vert_quals =
       map_onto(choices.quals, cands2verts, mesh->nverts(), -1.0, 1);
+  auto new_sol = choices.new_sol;
+  auto ncomps = new_sol.size() / mesh->nverts();
+  /* only the owner of a vertex is sure to have its full star.
+     the copies on the outer boundary of the ghost layer chose
+     their motion from part of it, and find_indset() does not
+     terminate unless all copies agree */
+  if (mesh->could_be_shared(VERT)) {
+    ExchBatch batch;
+    batch.add(&verts_are_cands, 1);
+    batch.add(&vert_quals, 1);
+    batch.add(&new_sol, ncomps);
+    batch.exch(mesh->ask_dist(VERT).invert());
+  }
+  if (get_sum(comm, verts_are_cands) == 0) return false;
   auto verts_are_keys = find_indset(mesh, VERT, vert_quals, verts_are_cands);
   mesh->add_tag(VERT, "key", 1, verts_are_keys);
-  auto ncomps = choices.new_sol.size() / mesh->nverts();
-  mesh->add_tag(VERT, "motion_solution", ncomps, choices.new_sol);
-  auto keys2verts = collect_marked(verts_are_keys);
-  auto verts2cav_elems = mesh->ask_up(VERT, mesh->dim());
-  set_owners_by_indset(mesh, VERT, keys2verts, verts2cav_elems);
+  mesh->add_tag(VERT, "motion_solution", ncomps, new_sol);
   return true;
 }
 
-static void move_verts_elem_based(Mesh* mesh, AdaptOpts const& opts) {
+/* moving vertices changes no topology, so unlike the other
+ * operations this one is applied to the ghosted mesh, which
+ * keeps the ghost layer for the next operation.
+ * with the motion synced above, vertex data and the edge and
+ * element data computed from it agree across copies.
+ * what does not is the transfer of element fields over the
+ * cavity of a key vertex, done with part of the cavity on the
+ * outer boundary of the ghost layer. the owner of an element
+ * holds the full star of each of its vertices, so the
+ * real-valued element tags, the only ones changed here,
+ * are synced from there. */
+static void sync_motion_tags(Mesh* mesh) {
+  auto dim = mesh->dim();
+  for (Int i = 0; i < mesh->ntags(dim); ++i) {
+    auto tagbase = mesh->get_tag(dim, i);
+    if (tagbase->type() != OMEGA_H_F64) continue;
+    mesh->sync_tag(dim, tagbase->name());
+  }
+}
+
+static void move_verts_ghosted2(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto verts_are_keys = mesh->get_array<I8>(VERT, "key");
   mesh->remove_tag(VERT, "key");
   auto new_sol = mesh->get_array<Real>(VERT, "motion_solution");
   mesh->remove_tag(VERT, "motion_solution");
   auto keys2verts = collect_marked(verts_are_keys);
+  if (stats) stats->nmoved_verts += keys2verts.size();
   if (opts.verbosity >= EACH_REBUILD) {
     auto nkeys = keys2verts.size();
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
@@ -74,6 +104,8 @@ static void move_verts_elem_based(Mesh* mesh, AdaptOpts const& opts) {
       auto same_edges2edges = collect_marked(edges_didnt_move);
       transfer_length(
           mesh, &new_mesh, same_edges2edges, same_edges2edges, new_edges2edges);
+      transfer_mident_metric(
+          mesh, &new_mesh, same_edges2edges, same_edges2edges, new_edges2edges);
     } else if (ent_dim == mesh->dim()) {
       auto elems_did_move =
           mark_up(&new_mesh, VERT, mesh->dim(), verts_are_keys);
@@ -90,13 +122,14 @@ static void move_verts_elem_based(Mesh* mesh, AdaptOpts const& opts) {
           keys2elems.a2ab, keys2elems.ab2b, same_elems2elems, same_elems2elems);
     }
   }
+  sync_motion_tags(&new_mesh);
   *mesh = new_mesh;
 }
 
-bool move_verts_for_quality(Mesh* mesh, AdaptOpts const& opts) {
+bool move_verts_for_quality(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   if (!move_verts_ghosted(mesh, opts)) return false;
-  mesh->set_parting(OMEGA_H_ELEM_BASED, false);
-  move_verts_elem_based(mesh, opts);
+  move_verts_ghosted2(mesh, opts, stats);
   return true;
 }
 
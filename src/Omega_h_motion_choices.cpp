@@ -31,6 +31,19 @@ MotionChoices motion_choices_tmpl(
   OMEGA_H_CHECK(max_steps >= 0);
   auto step_size = opts.motion_step_size;
   auto max_length = opts.max_length_allowed;
+  /* the gradient line search halves its step at most this many times,
+     i.e. down to 1/64 of the first trial length */
+  constexpr Int max_trials = 6;
+  /* elements within this much of the cavity minimum quality contribute
+     to the ascent direction, so that near-ties do not make the
+     direction flip between consecutive steps */
+  constexpr Real active_tolerance = 0.02;
+  /* steps never exceed this fraction of the shortest adjacent edge,
+     keeping the trial position inside the old cavity */
+  constexpr Real max_dist_factor = 0.5;
+  /* steps that improve the cavity minimum quality by less than this
+     end the ascent, since more would not change any later decision */
+  constexpr Real min_gain = 1e-3;
   OMEGA_H_CHECK(0.0 < step_size);
   OMEGA_H_CHECK(step_size < 1.0);
   auto did_move_w = Write<I8>(ncands);
@@ -38,9 +51,11 @@ MotionChoices motion_choices_tmpl(
   constexpr auto metric_ncomps = symm_ncomps(metric_dim);
   auto metrics_w = Write<Real>(ncands * metric_ncomps);
   auto qualities_w = Write<Real>(ncands);
+  auto use_gradient = opts.should_move_with_gradient;
   auto f = OMEGA_H_LAMBDA(LO cand) {
     auto v = cands2verts[cand];
     auto v_dim = verts2dim[v];
+    if (use_gradient && v_dim == mesh_dim) return;
     auto old_qual = cands2old_qual[cand];
     auto last_qual = old_qual;
     Vector<maxcomps> tmp;
@@ -122,6 +137,144 @@ MotionChoices motion_choices_tmpl(
     if (did_move) OMEGA_H_CHECK(last_qual >= 0.0);
   };
   parallel_for(ncands, f);
+  /* interior vertices may instead ascend along the quality gradients
+     of their worst elements, with a backtracking line search on the
+     minimum quality of their cavity. fields at trial positions are
+     interpolated inside the element of the old cavity containing them. */
+  auto g = OMEGA_H_LAMBDA(LO cand) {
+    auto v = cands2verts[cand];
+    if (!(use_gradient && verts2dim[v] == mesh_dim)) return;
+    auto old_qual = cands2old_qual[cand];
+    auto last_qual = old_qual;
+    auto x = get_vector<mesh_dim>(coords, v);
+    auto m = get_symm<metric_dim>(metrics, v);
+    Vector<maxcomps> sol;
+    for (Int i = 0; i < pack.ncomps; ++i) {
+      sol[i] = pack.data[v * pack.ncomps + i];
+    }
+    Real min_length = ArithTraits<Real>::max();
+    for (auto ve = v2e.a2ab[v]; ve < v2e.a2ab[v + 1]; ++ve) {
+      auto e = v2e.ab2b[ve];
+      auto evv2v = gather_verts<2>(ev2v, e);
+      auto evv2x = gather_vectors<2, mesh_dim>(coords, evv2v);
+      min_length = min2(min_length, norm(evv2x[1] - evv2x[0]));
+    }
+    auto dist = step_size * min_length;
+    LO last_vk = -1;
+    for (Int step = 0; step < max_steps; ++step) {
+      /* ascend along the sum of the unit gradients of the elements
+         whose quality is close to the minimum */
+      auto grad = zero_vector<mesh_dim>();
+      for (auto vk = v2k.a2ab[v]; vk < v2k.a2ab[v + 1]; ++vk) {
+        auto k = v2k.ab2b[vk];
+        auto kvv_c = code_which_down(v2k.codes[vk]);
+        auto kvv2v = gather_verts<mesh_dim + 1>(kv2v, k);
+        auto kvv2x = gather_vectors<mesh_dim + 1, mesh_dim>(coords, kvv2v);
+        kvv2x[kvv_c] = x;
+        auto kvv2m = gather_symms<mesh_dim + 1, metric_dim>(metrics, kvv2v);
+        kvv2m[kvv_c] = m;
+        auto km = maxdet_metric(kvv2m);
+        auto k_qual = metric_element_quality(kvv2x, km);
+        if (k_qual > last_qual + active_tolerance) continue;
+        auto k_grad = metric_element_quality_gradient(kvv2x, km, kvv_c);
+        auto k_grad_norm = norm(k_grad);
+        if (k_grad_norm > 0.0) grad = grad + k_grad / k_grad_norm;
+      }
+      auto grad_norm = norm(grad);
+      if (!(grad_norm > 0.0)) break;
+      auto dir = grad / grad_norm;
+      auto found_step = false;
+      /* the step length grows after a success and shrinks on failure */
+      dist = min2(2.0 * dist, max_dist_factor * min_length);
+      for (Int trial = 0; trial < max_trials; ++trial, dist /= 2.0) {
+        auto nx = x + dist * dir;
+        LO best_vk = -1;
+        Few<LO, mesh_dim + 1> best_kvv2v;
+        for (Int i = 0; i <= mesh_dim; ++i) best_kvv2v[i] = -1;
+        auto best_bc = zero_vector<mesh_dim + 1>();
+        auto begin = v2k.a2ab[v];
+        auto end = v2k.a2ab[v + 1];
+        /* start with the element that contained the last position */
+        for (auto i = begin - 1; i < end; ++i) {
+          auto vk = (i < begin) ? last_vk : i;
+          if (vk == -1 || (i >= begin && vk == last_vk)) continue;
+          auto kvv2v = gather_verts<mesh_dim + 1>(kv2v, v2k.ab2b[vk]);
+          auto kvv2x = gather_vectors<mesh_dim + 1, mesh_dim>(coords, kvv2v);
+          auto xi = invert(simplex_affine(kvv2x)) * nx;
+          auto bc = form_barycentric(xi);
+          if (best_vk == -1 || minimum(bc) > minimum(best_bc)) {
+            best_vk = vk;
+            best_kvv2v = kvv2v;
+            best_bc = bc;
+          }
+          if (minimum(best_bc) >= 0.0) break;
+        }
+        if (best_vk == -1) continue;
+        if (minimum(best_bc) < -EPSILON) continue;
+        Vector<maxcomps> tmp;
+        /* see form_barycentric() for the order of (best_bc) */
+        for (Int i = 0; i < pack.ncomps; ++i) {
+          auto nc = pack.ncomps;
+          tmp[i] = best_bc[mesh_dim] * pack.data[best_kvv2v[0] * nc + i];
+          for (Int j = 1; j <= mesh_dim; ++j) {
+            tmp[i] += best_bc[j - 1] * pack.data[best_kvv2v[j] * nc + i];
+          }
+        }
+        for (Int i = 0; i < mesh_dim; ++i) tmp[pack.coords_offset + i] = nx[i];
+        Vector<metric_ncomps> metric_comps;
+        for (Int i = 0; i < metric_ncomps; ++i) {
+          metric_comps[i] = tmp[pack.metric_offset + i];
+        }
+        auto nm = delinearize_metric(vector2symm(metric_comps));
+        auto overshoots = false;
+        for (auto ve = v2e.a2ab[v]; ve < v2e.a2ab[v + 1]; ++ve) {
+          auto e = v2e.ab2b[ve];
+          auto evv_c = code_which_down(v2e.codes[ve]);
+          auto ov = ev2v[e * 2 + (1 - evv_c)];
+          Few<Vector<mesh_dim>, 2> evv2nx;
+          Few<Metric, 2> evv2nm;
+          evv2nx[evv_c] = nx;
+          evv2nx[1 - evv_c] = get_vector<mesh_dim>(coords, ov);
+          evv2nm[evv_c] = nm;
+          evv2nm[1 - evv_c] = get_symm<metric_dim>(metrics, ov);
+          if (metric_edge_length(evv2nx, evv2nm) > max_length) {
+            overshoots = true;
+            break;
+          }
+        }
+        if (overshoots) continue;
+        Real new_qual = 1.0;
+        for (auto vk = v2k.a2ab[v]; vk < v2k.a2ab[v + 1]; ++vk) {
+          auto k = v2k.ab2b[vk];
+          auto kvv_c = code_which_down(v2k.codes[vk]);
+          auto kvv2v = gather_verts<mesh_dim + 1>(kv2v, k);
+          auto kvv2nx = gather_vectors<mesh_dim + 1, mesh_dim>(coords, kvv2v);
+          kvv2nx[kvv_c] = nx;
+          auto kvv2m = gather_symms<mesh_dim + 1, metric_dim>(metrics, kvv2v);
+          kvv2m[kvv_c] = nm;
+          auto k_qual = metric_element_quality(kvv2nx, maxdet_metric(kvv2m));
+          new_qual = min2(new_qual, k_qual);
+          if (new_qual <= last_qual) break;
+        }
+        if (new_qual <= last_qual) continue;
+        found_step = (last_qual <= 0.0) || (new_qual - last_qual > min_gain);
+        last_qual = new_qual;
+        last_vk = best_vk;
+        x = nx;
+        m = nm;
+        sol = tmp;
+        break;
+      }  // end line search
+      if (!found_step) break;
+    }  // end loop over gradient steps
+    for (Int i = 0; i < pack.ncomps; ++i) {
+      new_sol_w[v * pack.ncomps + i] = sol[i];
+    }
+    auto did_move = last_qual > old_qual;
+    qualities_w[cand] = last_qual;
+    did_move_w[cand] = did_move;
+  };
+  if (use_gradient) parallel_for(ncands, g);
   auto qualities = Reals(qualities_w);
   auto new_sol = Reals(new_sol_w);
   return {Read<I8>(did_move_w), Reals(qualities_w), Reals(new_sol_w)};
@@ -1,4 +1,5 @@
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_map.hpp"
 #include "Omega_h_metric.hpp"
 #include "Omega_h_motion.hpp"
 #include "Omega_h_shape.hpp"
@@ -30,7 +31,9 @@ LinearPack pack_linearized_fields(Mesh* mesh, TransferOpts const& opts) {
     if (!should_transfer_motion_linear(mesh, opts, tb)) continue;
     auto t = dynamic_cast<Tag<Real> const*>(tb);
     auto in = t->array();
-    if (is_metric(mesh, opts, VERT, tb)) {
+    if (tb->name() == "metric" && mesh->has_tag(VERT, "log_metric")) {
+      in = mesh->get_array<Real>(VERT, "log_metric");
+    } else if (is_metric(mesh, opts, VERT, tb)) {
       in = linearize_metrics(mesh->nverts(), in);
     }
     auto ncomps_in = tb->ncomps();
@@ -51,6 +54,8 @@ void unpack_linearized_fields(Mesh* old_mesh, TransferOpts const& opts,
     Mesh* new_mesh, Reals data, Read<I8> verts_are_keys) {
   OMEGA_H_CHECK(data.size() % new_mesh->nverts() == 0);
   auto ncomps = data.size() / new_mesh->nverts();
+  auto has_log = old_mesh->has_tag(VERT, "log_metric");
+  Reals new_logs;
   Int offset = 0;
   for (Int i = 0; i < old_mesh->ntags(VERT); ++i) {
     auto tb = old_mesh->get_tag(VERT, i);
@@ -64,11 +69,32 @@ void unpack_linearized_fields(Mesh* old_mesh, TransferOpts const& opts,
     };
     parallel_for(new_mesh->nverts(), f);
     auto out = Reals(out_w);
+    auto t = dynamic_cast<Tag<Real> const*>(tb);
+    auto prev = t->array();
+    if (has_log && tb->name() == "metric") {
+      /* only the keys need to be delinearized */
+      auto prev_logs = old_mesh->get_array<Real>(VERT, "log_metric");
+      auto logs_w = deep_copy(prev_logs);
+      auto keys2verts = collect_marked(verts_are_keys);
+      auto key_logs = unmap(keys2verts, out, ncomps_out);
+      map_into(key_logs, keys2verts, logs_w, ncomps_out);
+      new_logs = logs_w;
+      auto metrics_w = deep_copy(prev);
+      if (keys2verts.size()) {
+        auto key_metrics = delinearize_metrics(keys2verts.size(), key_logs);
+        map_into(key_metrics, keys2verts, metrics_w, ncomps_out);
+      }
+      if (new_mesh->has_tag(VERT, tb->name())) {
+        new_mesh->set_tag(VERT, tb->name(), Reals(metrics_w));
+      } else {
+        new_mesh->add_tag(VERT, tb->name(), ncomps_out, Reals(metrics_w));
+      }
+      offset += ncomps_out;
+      continue;
+    }
     if (is_metric(old_mesh, opts, VERT, tb)) {
       out = delinearize_metrics(old_mesh->nverts(), out);
     }
-    auto t = dynamic_cast<Tag<Real> const*>(tb);
-    auto prev = t->array();
     out_w = deep_copy(prev);
     auto f2 = OMEGA_H_LAMBDA(LO v) {
       if (!verts_are_keys[v]) return;
@@ -86,6 +112,12 @@ void unpack_linearized_fields(Mesh* old_mesh, TransferOpts const& opts,
     offset += ncomps_out;
   }
   OMEGA_H_CHECK(offset == ncomps);
+  if (has_log) {
+    /* after "metric", whose setting removes it */
+    new_mesh->remove_tag(VERT, "log_metric");
+    new_mesh->add_tag(VERT, "log_metric",
+        old_mesh->get_tagbase(VERT, "log_metric")->ncomps(), new_logs, true);
+  }
 }
 
 }  // end namespace Omega_h
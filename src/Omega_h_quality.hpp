@@ -39,6 +39,34 @@ OMEGA_H_INLINE Real metric_element_quality(
   return mean_ratio<dim>(s, msl);
 }
 
+/* the gradient of metric_element_quality() with respect to the
+ * position of vertex (ivert), holding the metric constant.
+ * with V the real size and S the sum of squared metric edge lengths,
+ * the quality is proportional to V^(2/dim) / S.
+ * the gradient of an inverted element is that of its metric size.
+ */
+
+template <Int dim, typename Metric>
+OMEGA_H_INLINE Vector<dim> metric_element_quality_gradient(
+    Few<Vector<dim>, dim + 1> p, Metric metric, Int ivert) {
+  auto b = simplex_basis<dim, dim>(p);
+  auto rs = element_size(b);
+  auto s = metric_size<dim>(rs, metric);
+  auto drs = get_volume_vert_gradient(p, ivert);
+  /* inverted elements have their metric size as quality */
+  if (s <= 0) return metric_size<dim>(1.0, metric) * drs;
+  auto ev = element_edge_vectors(p, b);
+  auto msl = mean_squared_metric_length(ev, metric);
+  auto q = mean_ratio<dim>(s, msl);
+  auto dmsl = zero_vector<dim>();
+  for (Int j = 0; j <= dim; ++j) {
+    if (j == ivert) continue;
+    dmsl = dmsl + metric_product_gradient(metric, p[ivert] - p[j]);
+  }
+  dmsl = dmsl / Real(decltype(ev)::size);
+  return q * (((2.0 / dim) / rs) * drs - dmsl / msl);
+}
+
 template <Int space_dim, Int metric_dim>
 struct MetricElementQualities {
   Reals coords;
@@ -47,14 +75,47 @@ struct MetricElementQualities {
       : coords(mesh->coords()), metrics(metrics_in) {}
   MetricElementQualities(Mesh const* mesh)
       : MetricElementQualities(mesh, mesh->get_array<Real>(VERT, "metric")) {}
+  OMEGA_H_DEVICE void gather(Few<LO, space_dim + 1> v,
+      Few<Vector<space_dim>, space_dim + 1>* p,
+      Few<Matrix<metric_dim, metric_dim>, space_dim + 1>* ms) const {
+    *p = gather_vectors<space_dim + 1, space_dim>(coords, v);
+    *ms = gather_symms<space_dim + 1, metric_dim>(metrics, v);
+  }
   OMEGA_H_DEVICE Real measure(Few<LO, space_dim + 1> v) const {
-    auto p = gather_vectors<space_dim + 1, space_dim>(coords, v);
-    auto ms = gather_symms<space_dim + 1, metric_dim>(metrics, v);
+    Few<Vector<space_dim>, space_dim + 1> p;
+    Few<Matrix<metric_dim, metric_dim>, space_dim + 1> ms;
+    gather(v, &p, &ms);
     auto m = maxdet_metric(ms);
     return metric_element_quality(p, m);
   }
 };
 
+/* the minimum quality of the elements that (cavity) proposes for (key).
+ * the elements are generated one at a time and never stored, so
+ * callers describe cavities instead of building arrays of them.
+ * (cavity) must provide:
+ *   Int count(LO key) const
+ *     the number of proposed elements, negative if (key) has no cavity
+ *   bool get(LO key, Int i, Few<Vector<dim>, dim + 1>* p,
+ *       Few<Matrix<metric_dim, metric_dim>, dim + 1>* ms) const
+ *     the points and point metrics of element (i), false to skip it
+ * keys without a cavity have a quality of -1.
+ */
+template <Int dim, Int metric_dim, typename Cavity>
+OMEGA_H_DEVICE Real cavity_min_quality(Cavity const& cavity, LO key) {
+  auto n = cavity.count(key);
+  if (n < 0) return -1.0;
+  Real minqual = 1.0;
+  for (Int i = 0; i < n; ++i) {
+    Few<Vector<dim>, dim + 1> p;
+    Few<Matrix<metric_dim, metric_dim>, dim + 1> ms;
+    if (!cavity.get(key, i, &p, &ms)) continue;
+    auto m = maxdet_metric(ms);
+    minqual = min2(minqual, metric_element_quality(p, m));
+  }
+  return minqual;
+}
+
 Reals measure_qualities(Mesh* mesh, LOs a2e, Reals metrics);
 Reals measure_qualities(Mesh* mesh, LOs a2e);
 Reals measure_qualities(Mesh* mesh);
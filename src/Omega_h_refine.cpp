@@ -1,6 +1,7 @@
 #include "Omega_h_refine.hpp"
 
 #include <iostream>
+#include <vector>
 
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_indset.hpp"
@@ -8,6 +9,7 @@
 #include "Omega_h_mesh.hpp"
 #include "Omega_h_modify.hpp"
 #include "Omega_h_refine_qualities.hpp"
+#include "Omega_h_refine_templates.hpp"
 #include "Omega_h_refine_topology.hpp"
 #include "Omega_h_transfer.hpp"
 
@@ -39,14 +41,18 @@ static bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts) {
   return true;
 }
 
-static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
+static void refine_element_based(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
   auto keys2edges = collect_marked(edges_are_keys);
   auto nkeys = keys2edges.size();
-  auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
-  if (opts.verbosity >= EACH_REBUILD && comm->rank() == 0) {
-    std::cout << "refining " << ntotal_keys << " edges\n";
+  if (stats) stats->nrefined_edges += nkeys;
+  if (opts.verbosity >= EACH_REBUILD) {
+    auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "refining " << ntotal_keys << " edges\n";
+    }
   }
   auto new_mesh = mesh->copy_meta();
   auto keys2midverts = LOs();
@@ -80,21 +86,117 @@ static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
   *mesh = new_mesh;
 }
 
-static bool refine(Mesh* mesh, AdaptOpts const& opts) {
+static bool refine_ghosted_templates(Mesh* mesh, AdaptOpts const& opts) {
+  auto comm = mesh->comm();
+  auto edges_are_cands = mesh->get_array<I8>(EDGE, "candidate");
+  mesh->remove_tag(EDGE, "candidate");
+  auto edges_are_keys = find_refine_templates(mesh, opts, edges_are_cands);
+  if (get_max(comm, edges_are_keys) != 1) return false;
+  mesh->add_tag(EDGE, "key", 1, edges_are_keys);
+  mesh->add_tag(
+      EDGE, "edge2rep_order", 1, get_edge2rep_order(mesh, edges_are_keys));
+  auto keys2edges = collect_marked(edges_are_keys);
+  /* find_refine_templates() ensured that all key edges
+     of an element have the same owner */
+  set_owners_by_indset(mesh, EDGE, keys2edges, mesh->ask_up(EDGE, mesh->dim()));
+  return true;
+}
+
+static void refine_element_based_templates(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
+  auto comm = mesh->comm();
+  auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
+  auto keys2edges = collect_marked(edges_are_keys);
+  auto nkeys = keys2edges.size();
+  if (stats) stats->nrefined_edges += nkeys;
+  if (opts.verbosity >= EACH_REBUILD) {
+    auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "refining " << ntotal_keys << " edges by templates\n";
+    }
+  }
+  /* the masks and diagonals (which evaluate midpoint metrics)
+     are shared by the products of every dimension */
+  std::vector<Read<I8>> masks(std::size_t(mesh->dim() + 1));
+  for (Int dim = EDGE; dim <= mesh->dim(); ++dim) {
+    masks[std::size_t(dim)] = get_template_masks(mesh, dim, edges_are_keys);
+  }
+  auto elem_diags =
+      get_template_diagonals(mesh, masks[std::size_t(mesh->dim())]);
+  auto new_mesh = mesh->copy_meta();
+  auto old_verts2new_verts = LOs();
+  auto old_edges2midverts = LOs();
+  auto old_lows2new_lows = LOs();
+  for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
+    auto keys2ents = keys2edges;
+    auto keys2prods = LOs();
+    auto prod_verts2verts = LOs();
+    auto prods2parent_dims = Read<I8>();
+    auto prods2parents = LOs();
+    if (ent_dim == VERT) {
+      keys2prods = LOs(nkeys + 1, 0, 1);
+    } else {
+      refine_template_products(mesh, ent_dim, masks, elem_diags,
+          old_verts2new_verts, old_edges2midverts, keys2ents, keys2prods,
+          prod_verts2verts, prods2parent_dims, prods2parents);
+    }
+    auto prods2new_ents = LOs();
+    auto same_ents2old_ents = LOs();
+    auto same_ents2new_ents = LOs();
+    auto old_ents2new_ents = LOs();
+    /* new vertices are keyed by their edges as usual,
+       higher products by the split entities of their own dimension */
+    auto key_dim = (ent_dim == VERT) ? EDGE : ent_dim;
+    modify_ents(mesh, &new_mesh, ent_dim, key_dim, keys2ents, keys2prods,
+        prod_verts2verts, old_lows2new_lows, &prods2new_ents,
+        &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    if (ent_dim == VERT) {
+      old_verts2new_verts = old_ents2new_ents;
+      old_edges2midverts =
+          map_onto(prods2new_ents, keys2edges, mesh->nedges(), -1, 1);
+      transfer_refine(mesh, opts.xfer_opts, &new_mesh, keys2edges,
+          prods2new_ents, ent_dim, keys2prods, prods2new_ents,
+          same_ents2old_ents, same_ents2new_ents);
+    } else {
+      transfer_refine_templates(mesh, opts.xfer_opts, &new_mesh, ent_dim,
+          prods2parent_dims, prods2parents, prods2new_ents,
+          same_ents2old_ents, same_ents2new_ents);
+    }
+    old_lows2new_lows = old_ents2new_ents;
+  }
+  *mesh = new_mesh;
+}
+
+/* template refinement has no notion of an edge cavity,
+   which conservative transfer is built on */
+static bool should_refine_with_templates(
+    Mesh* mesh, AdaptOpts const& opts) {
+  return opts.should_refine_with_templates && mesh->dim() > 1 &&
+         !should_conserve_any(mesh, opts.xfer_opts) &&
+         !has_momentum_velocity(mesh, opts.xfer_opts);
+}
+
+static bool refine(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   mesh->set_parting(OMEGA_H_GHOSTED);
+  if (should_refine_with_templates(mesh, opts)) {
+    if (!refine_ghosted_templates(mesh, opts)) return false;
+    mesh->set_parting(OMEGA_H_ELEM_BASED);
+    refine_element_based_templates(mesh, opts, stats);
+    return true;
+  }
   if (!refine_ghosted(mesh, opts)) return false;
   mesh->set_parting(OMEGA_H_ELEM_BASED);
-  refine_element_based(mesh, opts);
+  refine_element_based(mesh, opts, stats);
   return true;
 }
 
-bool refine_by_size(Mesh* mesh, AdaptOpts const& opts) {
+bool refine_by_size(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto lengths = mesh->ask_lengths();
   auto edge_is_cand = each_gt(lengths, opts.max_length_desired);
   if (get_max(comm, edge_is_cand) != 1) return false;
   mesh->add_tag(EDGE, "candidate", 1, edge_is_cand);
-  return refine(mesh, opts);
+  return refine(mesh, opts, stats);
 }
 
 }  // end namespace Omega_h
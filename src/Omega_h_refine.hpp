@@ -5,7 +5,8 @@
 
 namespace Omega_h {
 
-bool refine_by_size(Mesh* mesh, AdaptOpts const& opts);
+bool refine_by_size(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats = nullptr);
 
 }  // end namespace Omega_h
 
@@ -9,76 +9,77 @@
 
 namespace Omega_h {
 
+/* the cavity of splitting candidate edge (key) at its midpoint:
+   two new cells per adjacent cell */
 template <Int mesh_dim, Int metric_dim>
-struct MetricRefineQualities {
+struct RefineCavities {
+  LOs candidates;
+  LOs ev2v;
+  LOs cv2v;
+  LOs e2ec;
+  LOs ec2c;
+  Read<I8> ec_codes;
+  Reals coords;
   Reals vert_metrics;
   Reals midpt_metrics;
-  MetricRefineQualities(Mesh* mesh, LOs candidates)
-      : vert_metrics(mesh->get_array<Real>(VERT, "metric")),
-        /* TODO: we could reuse the results of this instead of recomputing
-         * them when transferring an OMEGA_H_METRIC field in transfer.cpp
-         */
-        midpt_metrics(get_mident_metrics(
-            mesh, EDGE, candidates, mesh->get_array<Real>(VERT, "metric"))) {}
-  OMEGA_H_DEVICE Real measure(Int cand, Few<Vector<mesh_dim>, mesh_dim + 1> p,
-      Few<LO, mesh_dim> csv2v) const {
-    Few<Matrix<metric_dim, metric_dim>, mesh_dim + 1> ms;
-    for (Int csv = 0; csv < mesh_dim; ++csv)
-      ms[csv] = get_symm<metric_dim>(vert_metrics, csv2v[csv]);
-    ms[mesh_dim] = get_symm<metric_dim>(midpt_metrics, cand);
-    auto m = maxdet_metric(ms);
-    return metric_element_quality(p, m);
+  RefineCavities(Mesh* mesh, LOs candidates_)
+      : candidates(candidates_),
+        ev2v(mesh->ask_verts_of(EDGE)),
+        cv2v(mesh->ask_verts_of(mesh_dim)),
+        coords(mesh->coords()),
+        vert_metrics(mesh->get_array<Real>(VERT, "metric")),
+        midpt_metrics(get_mident_metrics(mesh, EDGE, candidates_)) {
+    auto e2c = mesh->ask_up(EDGE, mesh_dim);
+    e2ec = e2c.a2ab;
+    ec2c = e2c.ab2b;
+    ec_codes = e2c.codes;
+  }
+  OMEGA_H_DEVICE Int count(LO cand) const {
+    auto e = candidates[cand];
+    return 2 * (e2ec[e + 1] - e2ec[e]);
+  }
+  OMEGA_H_DEVICE bool get(LO cand, Int i,
+      Few<Vector<mesh_dim>, mesh_dim + 1>* p,
+      Few<Matrix<metric_dim, metric_dim>, mesh_dim + 1>* ms) const {
+    auto e = candidates[cand];
+    auto ec = e2ec[e] + i / 2;
+    auto eev = i % 2;
+    auto c = ec2c[ec];
+    auto code = ec_codes[ec];
+    auto cce = code_which_down(code);
+    auto rot = code_rotation(code);
+    /* a new cell is formed from an old cell by finding
+       its side that is opposite to one of the edge endpoints
+       and connecting it to the midpoint to form the new cell
+       (see refine_domain_interiors) */
+    auto cev = eev ^ rot;
+    auto ccv = down_template(mesh_dim, EDGE, cce, cev);
+    auto ccs = opposite_template(mesh_dim, VERT, ccv);
+    Few<LO, mesh_dim> csv2v;
+    for (Int csv = 0; csv < mesh_dim; ++csv) {
+      auto ccv2 = down_template(mesh_dim, mesh_dim - 1, ccs, csv);
+      csv2v[csv] = cv2v[c * (mesh_dim + 1) + ccv2];
+    }
+    flip_new_elem<mesh_dim>(&csv2v[0]);
+    for (Int csv = 0; csv < mesh_dim; ++csv) {
+      (*p)[csv] = get_vector<mesh_dim>(coords, csv2v[csv]);
+      (*ms)[csv] = get_symm<metric_dim>(vert_metrics, csv2v[csv]);
+    }
+    auto eev2v = gather_verts<2>(ev2v, e);
+    auto ep = gather_vectors<2, mesh_dim>(coords, eev2v);
+    (*p)[mesh_dim] = (ep[0] + ep[1]) / 2.;
+    (*ms)[mesh_dim] = get_symm<metric_dim>(midpt_metrics, cand);
+    return true;
   }
 };
 
 template <Int mesh_dim, Int metric_dim>
 static Reals refine_qualities_tmpl(Mesh* mesh, LOs candidates) {
-  auto ev2v = mesh->ask_verts_of(EDGE);
-  auto cv2v = mesh->ask_verts_of(mesh_dim);
-  auto e2c = mesh->ask_up(EDGE, mesh_dim);
-  auto e2ec = e2c.a2ab;
-  auto ec2c = e2c.ab2b;
-  auto ec_codes = e2c.codes;
-  auto coords = mesh->coords();
   auto ncands = candidates.size();
-  auto measure = MetricRefineQualities<mesh_dim, metric_dim>(mesh, candidates);
+  auto cavities = RefineCavities<mesh_dim, metric_dim>(mesh, candidates);
   Write<Real> quals_w(ncands);
   auto f = OMEGA_H_LAMBDA(LO cand) {
-    auto e = candidates[cand];
-    auto eev2v = gather_verts<2>(ev2v, e);
-    auto ep = gather_vectors<2, mesh_dim>(coords, eev2v);
-    auto midp = (ep[0] + ep[1]) / 2.;
-    auto minqual = 1.0;
-    for (auto ec = e2ec[e]; ec < e2ec[e + 1]; ++ec) {
-      auto c = ec2c[ec];
-      auto code = ec_codes[ec];
-      auto cce = code_which_down(code);
-      auto rot = code_rotation(code);
-      auto ccv2v = gather_verts<mesh_dim + 1>(cv2v, c);
-      for (Int eev = 0; eev < 2; ++eev) {
-        /* a new cell is formed from an old cell by finding
-           its side that is opposite to one of the edge endpoints
-           and connecting it to the midpoint to form the new cell
-           (see refine_domain_interiors) */
-        auto cev = eev ^ rot;
-        auto ccv = down_template(mesh_dim, EDGE, cce, cev);
-        auto ccs = opposite_template(mesh_dim, VERT, ccv);
-        Few<LO, mesh_dim> csv2v;
-        Few<Vector<mesh_dim>, mesh_dim + 1> ncp;
-        for (Int csv = 0; csv < mesh_dim; ++csv) {
-          auto ccv2 = down_template(mesh_dim, mesh_dim - 1, ccs, csv);
-          auto v2 = ccv2v[ccv2];
-          csv2v[csv] = v2;
-          ncp[csv] = get_vector<mesh_dim>(coords, v2);
-        }
-        ncp[mesh_dim] = midp;
-        flip_new_elem<mesh_dim>(&csv2v[0]);
-        flip_new_elem<mesh_dim>(&ncp[0]);
-        auto cqual = measure.measure(cand, ncp, csv2v);
-        minqual = min2(minqual, cqual);
-      }
-    }
-    quals_w[cand] = minqual;
+    quals_w[cand] = cavity_min_quality<mesh_dim, metric_dim>(cavities, cand);
   };
   parallel_for(ncands, f, "refine_qualities");
   auto cand_quals = Reals(quals_w);
@@ -0,0 +1,330 @@
+#include "Omega_h_refine_templates.hpp"
+
+#include <vector>
+
+#include "Omega_h_adapt.hpp"
+#include "Omega_h_align.hpp"
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_loop.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_metric.hpp"
+#include "Omega_h_quality.hpp"
+#include "Omega_h_scan.hpp"
+
+namespace Omega_h {
+
+enum { MAX_TEMPLATE_POINTS = 10 };
+
+template <Int dim, Int metric_dim>
+struct TemplateQualities {
+  Reals coords;
+  Reals vert_metrics;
+  Reals midpt_metrics;
+  LOs elems2verts;
+  LOs elems2edges;
+  TemplateQualities(Mesh* mesh)
+      : coords(mesh->coords()),
+        vert_metrics(mesh->get_array<Real>(VERT, "metric")),
+        midpt_metrics(
+            get_mident_metrics(mesh, EDGE, LOs(mesh->nedges(), 0, 1))),
+        elems2verts(mesh->ask_elem_verts()),
+        elems2edges(mesh->ask_down(dim, EDGE).ab2b) {}
+  /* the minimum quality of the children of (elem)
+     when split by template (mask) */
+  OMEGA_H_DEVICE Real measure(LO elem, Int mask, Int diag) const {
+    auto nedges = simplex_degree(dim, EDGE);
+    Few<Vector<dim>, MAX_TEMPLATE_POINTS> tp;
+    Few<Matrix<metric_dim, metric_dim>, MAX_TEMPLATE_POINTS> tm;
+    for (Int v = 0; v <= dim; ++v) {
+      auto vert = elems2verts[elem * (dim + 1) + v];
+      tp[v] = get_vector<dim>(coords, vert);
+      tm[v] = get_symm<metric_dim>(vert_metrics, vert);
+    }
+    for (Int e = 0; e < nedges; ++e) {
+      if (!(mask & (1 << e))) continue;
+      auto a = down_template(dim, EDGE, e, 0);
+      auto b = down_template(dim, EDGE, e, 1);
+      tp[dim + 1 + e] = (tp[a] + tp[b]) / 2.;
+      tm[dim + 1 + e] =
+          get_symm<metric_dim>(midpt_metrics, elems2edges[elem * nedges + e]);
+    }
+    auto minqual = 1.0;
+    auto nchildren = count_template_prods(dim, mask, dim);
+    for (Int child = 0; child < nchildren; ++child) {
+      Int ctv2tv[dim + 1];
+      get_template_prod(dim, mask, diag, dim, child, ctv2tv);
+      Few<Vector<dim>, dim + 1> cp;
+      Few<Matrix<metric_dim, metric_dim>, dim + 1> cm;
+      for (Int ctv = 0; ctv <= dim; ++ctv) {
+        cp[ctv] = tp[ctv2tv[ctv]];
+        cm[ctv] = tm[ctv2tv[ctv]];
+      }
+      auto m = maxdet_metric(cm);
+      minqual = min2(minqual, metric_element_quality(cp, m));
+    }
+    return minqual;
+  }
+  /* the octahedron diagonal giving the best 1:8 split */
+  OMEGA_H_DEVICE Int choose_diagonal(LO elem, Int mask) const {
+    if (dim != 3 || mask != full_template_mask(dim)) return 0;
+    Int best_diag = 0;
+    auto best_qual = measure(elem, mask, 0);
+    for (Int diag = 1; diag < 3; ++diag) {
+      auto qual = measure(elem, mask, diag);
+      if (qual > best_qual) {
+        best_diag = diag;
+        best_qual = qual;
+      }
+    }
+    return best_diag;
+  }
+};
+
+template <Int dim, Int metric_dim>
+static Read<I8> find_refine_templates_tmpl(
+    Mesh* mesh, AdaptOpts const& opts, Read<I8> edges_are_cands) {
+  auto nelem_edges = simplex_degree(dim, EDGE);
+  auto comm = mesh->comm();
+  auto quals = TemplateQualities<dim, metric_dim>(mesh);
+  auto elems2edges = quals.elems2edges;
+  auto edges2elems = mesh->ask_up(EDGE, dim);
+  auto e2ec = edges2elems.a2ab;
+  auto ec2c = edges2elems.ab2b;
+  auto ec_codes = edges2elems.codes;
+  auto lengths = mesh->ask_lengths();
+  auto globals = mesh->globals(EDGE);
+  auto edge_ranks = mesh->ask_owners(EDGE).ranks;
+  auto min_qual = opts.min_quality_allowed;
+  auto nelems = mesh->nelems();
+  auto nedges = mesh->nedges();
+  auto edges_are_marked = edges_are_cands;
+  while (true) {
+    Write<I8> elem_masks(nelems);
+    Write<I32> elem_ranks(nelems);
+    /* each element keeps the largest allowed template around
+       its highest priority marked edge */
+    auto choose = OMEGA_H_LAMBDA(LO elem) {
+      Int mask = 0;
+      Int top = -1;
+      for (Int ee = 0; ee < nelem_edges; ++ee) {
+        auto e = elems2edges[elem * nelem_edges + ee];
+        if (!edges_are_marked[e]) continue;
+        mask |= (1 << ee);
+        if (top >= 0) {
+          auto te = elems2edges[elem * nelem_edges + top];
+          if (lengths[e] < lengths[te]) continue;
+          if (lengths[e] == lengths[te] && globals[e] < globals[te]) continue;
+        }
+        top = ee;
+      }
+      Int keep = 0;
+      if (mask) {
+        auto full = full_template_mask(dim);
+        if (mask == full &&
+            quals.measure(elem, full, quals.choose_diagonal(elem, full)) >=
+                min_qual) {
+          keep = full;
+        }
+        for (Int f = 0; dim == 3 && !keep && f < 4; ++f) {
+          auto fmask = face_template_mask(dim, f);
+          if (!(fmask & (1 << top)) || ((mask & fmask) != fmask)) continue;
+          if (quals.measure(elem, fmask, 0) >= min_qual) keep = fmask;
+        }
+        if (!keep && quals.measure(elem, 1 << top, 0) >= min_qual) {
+          keep = (1 << top);
+        }
+      }
+      elem_masks[elem] = I8(keep);
+      elem_ranks[elem] =
+          keep ? edge_ranks[elems2edges[elem * nelem_edges + top]] : -1;
+    };
+    parallel_for(nelems, choose, "find_refine_templates(choose)");
+    /* an edge stays marked if all its elements keep it and
+       all of them will be split by the owner of the edge */
+    Write<I8> new_marks(nedges);
+    auto agree = OMEGA_H_LAMBDA(LO e) {
+      I8 keep = edges_are_marked[e];
+      for (auto ec = e2ec[e]; keep && ec < e2ec[e + 1]; ++ec) {
+        auto elem = ec2c[ec];
+        auto ee = code_which_down(ec_codes[ec]);
+        if (!(elem_masks[elem] & (1 << ee))) keep = 0;
+        if (elem_ranks[elem] != edge_ranks[e]) keep = 0;
+      }
+      new_marks[e] = keep;
+    };
+    parallel_for(nedges, agree, "find_refine_templates(agree)");
+    auto synced_marks = mesh->sync_array(EDGE, Read<I8>(new_marks), 1);
+    auto changed = !(synced_marks == edges_are_marked);
+    edges_are_marked = synced_marks;
+    if (!comm->reduce_or(changed)) break;
+  }
+  return edges_are_marked;
+}
+
+Read<I8> find_refine_templates(
+    Mesh* mesh, AdaptOpts const& opts, Read<I8> edges_are_cands) {
+  auto mesh_dim = mesh->dim();
+  auto metric_dim = get_metric_dim(mesh);
+  if (mesh_dim == 3 && metric_dim == 3) {
+    return find_refine_templates_tmpl<3, 3>(mesh, opts, edges_are_cands);
+  }
+  if (mesh_dim == 2 && metric_dim == 2) {
+    return find_refine_templates_tmpl<2, 2>(mesh, opts, edges_are_cands);
+  }
+  if (mesh_dim == 3 && metric_dim == 1) {
+    return find_refine_templates_tmpl<3, 1>(mesh, opts, edges_are_cands);
+  }
+  if (mesh_dim == 2 && metric_dim == 1) {
+    return find_refine_templates_tmpl<2, 1>(mesh, opts, edges_are_cands);
+  }
+  OMEGA_H_NORETURN(Read<I8>());
+}
+
+Read<I8> get_template_masks(Mesh* mesh, Int dim, Read<I8> edges_are_keys) {
+  if (dim == EDGE) return edges_are_keys;
+  auto nents = mesh->nents(dim);
+  auto ents2edges = mesh->ask_down(dim, EDGE).ab2b;
+  auto nent_edges = simplex_degree(dim, EDGE);
+  Write<I8> masks(nents);
+  auto f = OMEGA_H_LAMBDA(LO ent) {
+    Int mask = 0;
+    for (Int ee = 0; ee < nent_edges; ++ee) {
+      if (edges_are_keys[ents2edges[ent * nent_edges + ee]]) mask |= (1 << ee);
+    }
+    masks[ent] = I8(mask);
+  };
+  parallel_for(nents, f, "get_template_masks");
+  return masks;
+}
+
+template <Int metric_dim>
+static Read<I8> get_template_diagonals_tmpl(Mesh* mesh, Read<I8> elem_masks) {
+  auto quals = TemplateQualities<3, metric_dim>(mesh);
+  Write<I8> diags(mesh->nelems());
+  auto f = OMEGA_H_LAMBDA(LO elem) {
+    diags[elem] = I8(quals.choose_diagonal(elem, elem_masks[elem]));
+  };
+  parallel_for(mesh->nelems(), f, "get_template_diagonals");
+  return diags;
+}
+
+Read<I8> get_template_diagonals(Mesh* mesh, Read<I8> elem_masks) {
+  if (mesh->dim() != 3) return Read<I8>(mesh->nelems(), 0);
+  if (get_metric_dim(mesh) == 3) {
+    return get_template_diagonals_tmpl<3>(mesh, elem_masks);
+  }
+  return get_template_diagonals_tmpl<1>(mesh, elem_masks);
+}
+
+/* appends the products of dimension (ent_dim) of the split entities
+   of dimension (parent_dim) to the keys they are attached to */
+static void fill_template_products(Mesh* mesh, Int ent_dim, Int parent_dim,
+    Read<I8> ent_masks, Read<I8> parent_masks, Read<I8> parent_diags,
+    LOs keys2ents, LOs old_verts2new_verts, LOs old_edges2midverts,
+    Write<LO> keys2next, Write<LO> prod_verts2verts,
+    Write<I8> prods2parent_dims, Write<LO> prods2parents, bool just_count) {
+  auto nkeys = keys2ents.size();
+  auto parents2verts = mesh->ask_verts_of(parent_dim);
+  auto parents2edges =
+      (parent_dim == EDGE) ? LOs() : mesh->ask_down(parent_dim, EDGE).ab2b;
+  auto parents2ents = (parent_dim == ent_dim)
+                          ? LOs()
+                          : mesh->ask_down(parent_dim, ent_dim).ab2b;
+  auto ents2parents = (parent_dim == ent_dim)
+                          ? Graph(LOs(mesh->nents(ent_dim) + 1, 0, 1),
+                                LOs(mesh->nents(ent_dim), 0, 1))
+                          : Graph(mesh->ask_up(ent_dim, parent_dim));
+  auto e2ep = ents2parents.a2ab;
+  auto ep2p = ents2parents.ab2b;
+  auto nparent_verts = parent_dim + 1;
+  auto nparent_edges = simplex_degree(parent_dim, EDGE);
+  auto nparent_ents = simplex_degree(parent_dim, ent_dim);
+  auto nprod_verts = ent_dim + 1;
+  auto f = OMEGA_H_LAMBDA(LO key) {
+    auto ent = keys2ents[key];
+    auto prod = keys2next[key];
+    for (auto ep = e2ep[ent]; ep < e2ep[ent + 1]; ++ep) {
+      auto parent = ep2p[ep];
+      Int mask = parent_masks[parent];
+      if (!mask) continue;
+      if (parent_dim != ent_dim) {
+        /* interior products are attached to the first
+           split subentity of the parent */
+        LO first = -1;
+        for (Int pe = 0; pe < nparent_ents; ++pe) {
+          auto pent = parents2ents[parent * nparent_ents + pe];
+          if (ent_masks[pent]) {
+            first = pent;
+            break;
+          }
+        }
+        if (first != ent) continue;
+      }
+      Int diag = (parent_dim == 3) ? Int(parent_diags[parent]) : 0;
+      auto nprods = count_template_prods(parent_dim, mask, ent_dim);
+      for (Int i = 0; i < nprods; ++i) {
+        if (!just_count) {
+          Int ptv2tv[4];
+          get_template_prod(parent_dim, mask, diag, ent_dim, i, ptv2tv);
+          for (Int ptv = 0; ptv < nprod_verts; ++ptv) {
+            auto tv = ptv2tv[ptv];
+            LO v;
+            if (tv < nparent_verts) {
+              v = old_verts2new_verts[parents2verts[parent * nparent_verts +
+                                                    tv]];
+            } else {
+              auto pe = tv - nparent_verts;
+              auto edge = (parent_dim == EDGE)
+                              ? parent
+                              : parents2edges[parent * nparent_edges + pe];
+              v = old_edges2midverts[edge];
+            }
+            prod_verts2verts[prod * nprod_verts + ptv] = v;
+          }
+          prods2parent_dims[prod] = I8(parent_dim);
+          prods2parents[prod] = parent;
+        }
+        ++prod;
+      }
+    }
+    keys2next[key] = prod;
+  };
+  parallel_for(nkeys, f, "fill_template_products");
+}
+
+void refine_template_products(Mesh* mesh, Int ent_dim,
+    std::vector<Read<I8>> const& masks, Read<I8> elem_diags,
+    LOs old_verts2new_verts, LOs old_edges2midverts, LOs& keys2ents,
+    LOs& keys2prods, LOs& prod_verts2verts, Read<I8>& prods2parent_dims,
+    LOs& prods2parents) {
+  auto mesh_dim = mesh->dim();
+  auto ent_masks = masks[std::size_t(ent_dim)];
+  keys2ents = collect_marked(each_neq_to(ent_masks, I8(0)));
+  auto nkeys = keys2ents.size();
+  /* first count the products of each key, then fill them in */
+  Write<LO> keys2next(nkeys, 0);
+  for (Int dim = ent_dim; dim <= mesh_dim; ++dim) {
+    fill_template_products(mesh, ent_dim, dim, ent_masks,
+        masks[std::size_t(dim)], elem_diags, keys2ents, old_verts2new_verts,
+        old_edges2midverts, keys2next, Write<LO>(), Write<I8>(), Write<LO>(),
+        true);
+  }
+  keys2prods = offset_scan(LOs(keys2next));
+  auto nprods = keys2prods.last();
+  Write<LO> prod_verts2verts_w(nprods * (ent_dim + 1));
+  Write<I8> prods2parent_dims_w(nprods);
+  Write<LO> prods2parents_w(nprods);
+  keys2next = deep_copy(keys2prods);
+  for (Int dim = ent_dim; dim <= mesh_dim; ++dim) {
+    fill_template_products(mesh, ent_dim, dim, ent_masks,
+        masks[std::size_t(dim)], elem_diags, keys2ents, old_verts2new_verts,
+        old_edges2midverts, keys2next, prod_verts2verts_w,
+        prods2parent_dims_w, prods2parents_w, false);
+  }
+  prod_verts2verts = prod_verts2verts_w;
+  prods2parent_dims = prods2parent_dims_w;
+  prods2parents = prods2parents_w;
+}
+
+}  // end namespace Omega_h
@@ -0,0 +1,286 @@
+#ifndef OMEGA_H_REFINE_TEMPLATES_HPP
+#define OMEGA_H_REFINE_TEMPLATES_HPP
+
+#include <vector>
+
+#include <Omega_h_array.hpp>
+#include <Omega_h_few.hpp>
+#include <Omega_h_scalar.hpp>
+#include <Omega_h_simplex.hpp>
+
+namespace Omega_h {
+
+class Mesh;
+struct AdaptOpts;
+
+/* template refinement splits every simplex according to
+   the subset of its edges that are marked, encoded as a bit mask
+   over its local edges.
+   the allowed masks are the 1:2 split of a single edge,
+   the 1:4 split of one triangle (all three edges of one face of a tet)
+   and the 1:8 split of a tet (all six edges).
+   inside one simplex, "template points" are numbered as its (dim + 1)
+   vertices followed by the midpoints of its local edges.
+   all products are formed by substituting midpoints for vertices,
+   which preserves orientation, except for the four tets
+   inside the octahedron of a 1:8 split, which depend on
+   which of the three octahedron diagonals (diag) is chosen. */
+
+OMEGA_H_INLINE Int template_midpoint(Int dim, Int a, Int b) {
+  for (Int e = 0; e < simplex_degree(dim, EDGE); ++e) {
+    auto ea = down_template(dim, EDGE, e, 0);
+    auto eb = down_template(dim, EDGE, e, 1);
+    if ((ea == a && eb == b) || (ea == b && eb == a)) return dim + 1 + e;
+  }
+  return -1;
+}
+
+OMEGA_H_INLINE Int full_template_mask(Int dim) {
+  return (1 << simplex_degree(dim, EDGE)) - 1;
+}
+
+OMEGA_H_INLINE Int face_template_mask(Int dim, Int face) {
+  Int mask = 0;
+  for (Int i = 0; i < 3; ++i) {
+    auto a = down_template(dim, TRI, face, i);
+    auto b = down_template(dim, TRI, face, (i + 1) % 3);
+    mask |= (1 << (template_midpoint(dim, a, b) - (dim + 1)));
+  }
+  return mask;
+}
+
+/* returns the face of a tet split 1:4 by (mask), -1 otherwise */
+OMEGA_H_INLINE Int which_template_face(Int dim, Int mask) {
+  if (dim == 2) return (mask == full_template_mask(2)) ? 0 : -1;
+  if (dim != 3) return -1;
+  for (Int f = 0; f < 4; ++f) {
+    if (mask == face_template_mask(3, f)) return f;
+  }
+  return -1;
+}
+
+/* returns the edge split 1:2 by (mask), -1 otherwise */
+OMEGA_H_INLINE Int which_template_edge(Int mask) {
+  for (Int e = 0; e < 6; ++e) {
+    if (mask == (1 << e)) return e;
+  }
+  return -1;
+}
+
+OMEGA_H_INLINE bool is_template_mask(Int dim, Int mask) {
+  if (mask == 0) return true;
+  if (which_template_edge(mask) >= 0) return true;
+  if (dim >= 2 && which_template_face(dim, mask) >= 0) return true;
+  return mask == full_template_mask(dim);
+}
+
+/* the number of products of dimension (prod_dim) strictly inside
+   a simplex of dimension (dim) split by (mask).
+   when (prod_dim == dim) these are the children of the simplex. */
+OMEGA_H_INLINE Int count_template_prods(Int dim, Int mask, Int prod_dim) {
+  if (mask == 0 || prod_dim > dim || prod_dim < EDGE) return 0;
+  if (which_template_edge(mask) >= 0) {
+    if (prod_dim == dim) return 2;
+    if (prod_dim == dim - 1) return 1;
+    return 0;
+  }
+  if (dim == 3 && mask == full_template_mask(3)) {
+    if (prod_dim == 3) return 8;
+    if (prod_dim == 2) return 8;
+    return 1;
+  }
+  /* 1:4 split of a triangle or of one face of a tet */
+  if (prod_dim == dim) return 4;
+  if (prod_dim == dim - 1) return 3;
+  return 0;
+}
+
+OMEGA_H_INLINE Int octahedron_diagonal(Int diag, Int end) {
+  switch (diag) {
+    case 0:
+      return 4 + (end ? 5 : 0);
+    case 1:
+      return 4 + (end ? 3 : 1);
+    case 2:
+      return 4 + (end ? 4 : 2);
+  }
+  return -1;
+}
+
+/* the midpoints around diagonal (diag), ordered such that
+   (diagonal[0], diagonal[1], equator[i], equator[i + 1])
+   is a positively oriented tet */
+OMEGA_H_INLINE Int octahedron_equator(Int diag, Int i) {
+  switch (diag) {
+    case 0:
+      switch (i) {
+        case 0:
+          return 5;
+        case 1:
+          return 6;
+        case 2:
+          return 7;
+        case 3:
+          return 8;
+      }
+      return -1;
+    case 1:
+      switch (i) {
+        case 0:
+          return 4;
+        case 1:
+          return 8;
+        case 2:
+          return 9;
+        case 3:
+          return 6;
+      }
+      return -1;
+    case 2:
+      switch (i) {
+        case 0:
+          return 4;
+        case 1:
+          return 5;
+        case 2:
+          return 9;
+        case 3:
+          return 7;
+      }
+      return -1;
+  }
+  return -1;
+}
+
+/* the simplex at vertex (v) in which the vertices whose bits
+   are set in (which) are replaced by their midpoints with (v) */
+OMEGA_H_INLINE void template_corner(
+    Int dim, Int v, Int which, Int prod_verts[]) {
+  for (Int w = 0; w <= dim; ++w) {
+    prod_verts[w] =
+        ((which & (1 << w)) && w != v) ? template_midpoint(dim, v, w) : w;
+  }
+}
+
+/* writes the template points of product (prod) of dimension (prod_dim),
+   as enumerated by count_template_prods(), into (prod_verts) */
+OMEGA_H_INLINE void get_template_prod(
+    Int dim, Int mask, Int diag, Int prod_dim, Int prod, Int prod_verts[]) {
+  auto edge = which_template_edge(mask);
+  if (edge >= 0) {
+    auto a = down_template(dim, EDGE, edge, 0);
+    auto b = down_template(dim, EDGE, edge, 1);
+    auto m = dim + 1 + edge;
+    if (prod_dim == dim) {
+      for (Int v = 0; v <= dim; ++v) prod_verts[v] = v;
+      prod_verts[prod ? a : b] = m;
+    } else {
+      Int n = 0;
+      prod_verts[n++] = m;
+      for (Int v = 0; v <= dim; ++v) {
+        if (v != a && v != b) prod_verts[n++] = v;
+      }
+    }
+    return;
+  }
+  if (dim == 3 && mask == full_template_mask(3)) {
+    auto p = octahedron_diagonal(diag, 0);
+    auto q = octahedron_diagonal(diag, 1);
+    if (prod_dim == 3) {
+      if (prod < 4) {
+        template_corner(3, prod, 0xF, prod_verts);
+      } else {
+        auto i = prod - 4;
+        prod_verts[0] = p;
+        prod_verts[1] = q;
+        prod_verts[2] = octahedron_equator(diag, i);
+        prod_verts[3] = octahedron_equator(diag, (i + 1) % 4);
+      }
+    } else if (prod_dim == 2) {
+      if (prod < 4) {
+        Int n = 0;
+        for (Int w = 0; w < 4; ++w) {
+          if (w != prod) prod_verts[n++] = template_midpoint(3, prod, w);
+        }
+      } else {
+        prod_verts[0] = p;
+        prod_verts[1] = q;
+        prod_verts[2] = octahedron_equator(diag, prod - 4);
+      }
+    } else {
+      prod_verts[0] = p;
+      prod_verts[1] = q;
+    }
+    return;
+  }
+  auto face = which_template_face(dim, mask);
+  Few<Int, 3> fv;
+  for (Int i = 0; i < 3; ++i) {
+    fv[i] = (dim == 2) ? i : down_template(dim, TRI, face, i);
+  }
+  /* keep the face vertices in the order they appear in the simplex,
+     the medial triangle then keeps the orientation of the face */
+  for (Int i = 0; i < 2; ++i) {
+    for (Int j = 0; j < 2 - i; ++j) {
+      if (fv[j] > fv[j + 1]) swap2(fv[j], fv[j + 1]);
+    }
+  }
+  Int apex = -1;
+  for (Int v = 0; v <= dim; ++v) {
+    if (v != fv[0] && v != fv[1] && v != fv[2]) apex = v;
+  }
+  if (prod_dim == dim) {
+    if (prod < 3) {
+      auto v = fv[prod];
+      Int which = (1 << fv[(prod + 1) % 3]) | (1 << fv[(prod + 2) % 3]);
+      template_corner(dim, v, which, prod_verts);
+    } else {
+      for (Int v = 0; v <= dim; ++v) prod_verts[v] = v;
+      for (Int i = 0; i < 3; ++i) {
+        prod_verts[fv[i]] = template_midpoint(dim, fv[i], fv[(i + 1) % 3]);
+      }
+    }
+  } else {
+    prod_verts[0] = template_midpoint(dim, fv[prod], fv[(prod + 1) % 3]);
+    prod_verts[1] =
+        template_midpoint(dim, fv[(prod + 1) % 3], fv[(prod + 2) % 3]);
+    if (apex >= 0) prod_verts[2] = apex;
+  }
+}
+
+/* ghosted mode: starting from the marked candidate edges,
+   unmark edges until every element is split by an allowed template
+   whose products meet opts.min_quality_allowed, and until all
+   elements adjacent to a marked edge agree on the MPI rank
+   that will split them (the owner of their longest marked edge).
+   returns the final marks, consistent across ranks */
+Read<I8> find_refine_templates(
+    Mesh* mesh, AdaptOpts const& opts, Read<I8> edges_are_cands);
+
+/* element-based mode: given the marked edges, computes the template
+   mask of every entity of dimension (dim) (zero if it is not split)
+   and the octahedron diagonal of 1:8 tets (zero otherwise) */
+Read<I8> get_template_masks(Mesh* mesh, Int dim, Read<I8> edges_are_keys);
+Read<I8> get_template_diagonals(Mesh* mesh, Read<I8> elem_masks);
+
+/* builds the products of dimension (ent_dim >= EDGE) for template
+   refinement, keyed by the split entities of that same dimension
+   (keys2ents).
+   (masks) holds the template masks of every dimension from EDGE up,
+   (elem_diags) the element diagonals; both are computed once
+   per refinement pass by the caller.
+   every split entity of dimension (ent_dim) produces its children,
+   and every split entity of higher dimension attaches its interior
+   products of dimension (ent_dim) to its first split subentity
+   of dimension (ent_dim).
+   (prods2parent_dims, prods2parents) identify the old entity
+   containing each product, for inheritance of tags. */
+void refine_template_products(Mesh* mesh, Int ent_dim,
+    std::vector<Read<I8>> const& masks, Read<I8> elem_diags,
+    LOs old_verts2new_verts, LOs old_edges2midverts, LOs& keys2ents,
+    LOs& keys2prods, LOs& prod_verts2verts, Read<I8>& prods2parent_dims,
+    LOs& prods2parents);
+
+}  // end namespace Omega_h
+
+#endif
@@ -318,11 +318,41 @@ OMEGA_H_INLINE Sphere<1> get_inball(Few<Vector<1>, 2> p) {
   return {average(p), fabs((p[1] - p[0])[0] / 2.0)};
 }
 
+/* the gradients of the signed element_size() with respect to
+   each basis vector */
+
+OMEGA_H_INLINE Few<Vector<1>, 1> element_size_gradients(Few<Vector<1>, 1>) {
+  Few<Vector<1>, 1> g;
+  g[0] = vector_1(1.0);
+  return g;
+}
+
+OMEGA_H_INLINE Few<Vector<2>, 2> element_size_gradients(Few<Vector<2>, 2> b) {
+  Few<Vector<2>, 2> g;
+  g[0] = -perp(b[1]) / 2.0;
+  g[1] = perp(b[0]) / 2.0;
+  return g;
+}
+
+OMEGA_H_INLINE Few<Vector<3>, 3> element_size_gradients(Few<Vector<3>, 3> b) {
+  Few<Vector<3>, 3> g;
+  g[0] = cross(b[1], b[2]) / 6.0;
+  g[1] = cross(b[2], b[0]) / 6.0;
+  g[2] = cross(b[0], b[1]) / 6.0;
+  return g;
+}
+
+/* differentiating the basis directly avoids the side lookup tables,
+   whose out-of-range paths the compiler cannot rule out once this
+   is inlined with a runtime (ivert) */
 template <Int dim>
-Vector<dim> get_volume_vert_gradient(Few<Vector<dim>, dim + 1> p, Int ivert) {
-  auto iside = opposite_template(dim, VERT, ivert);
-  auto n = -get_side_normal(p, iside);
-  return n / Real(factorial(dim));
+OMEGA_H_INLINE Vector<dim> get_volume_vert_gradient(
+    Few<Vector<dim>, dim + 1> p, Int ivert) {
+  auto g = element_size_gradients(simplex_basis<dim, dim>(p));
+  if (ivert != 0) return g[ivert - 1];
+  auto g0 = zero_vector<dim>();
+  for (Int i = 0; i < dim; ++i) g0 = g0 - g[i];
+  return g0;
 }
 
 /* This code is copied from the tricircumcenter3d() function
@@ -39,9 +39,9 @@ Read<I8> filter_swap_improve(Mesh* mesh, LOs cands2edges, Reals cand_quals) {
   return gt_each(cand_quals, cand_old_quals);
 }
 
-bool swap_edges(Mesh* mesh, AdaptOpts const& opts) {
-  if (mesh->dim() == 3) return swap_edges_3d(mesh, opts);
-  if (mesh->dim() == 2) return swap_edges_2d(mesh, opts);
+bool swap_edges(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
+  if (mesh->dim() == 3) return swap_edges_3d(mesh, opts, stats);
+  if (mesh->dim() == 2) return swap_edges_2d(mesh, opts, stats);
   return false;
 }
 
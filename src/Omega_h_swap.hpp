@@ -11,7 +11,8 @@ void filter_swap(
     Read<I8> keep_cands, LOs* cands2edges, Reals* cand_quals = nullptr);
 Read<I8> filter_swap_improve(Mesh* mesh, LOs cands2edges, Reals cand_quals);
 
-bool swap_edges(Mesh* mesh, AdaptOpts const& opts);
+bool swap_edges(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats = nullptr);
 
 }  // end namespace Omega_h
 
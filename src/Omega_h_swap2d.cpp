@@ -32,11 +32,13 @@ static bool swap2d_ghosted(Mesh* mesh, AdaptOpts const& opts) {
   return true;
 }
 
-static void swap2d_element_based(Mesh* mesh, AdaptOpts const& opts) {
+static void swap2d_element_based(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
   mesh->remove_tag(EDGE, "key");
   auto keys2edges = collect_marked(edges_are_keys);
+  if (stats) stats->nswapped_edges += keys2edges.size();
   if (opts.verbosity >= EACH_REBUILD) {
     auto nkeys = keys2edges.size();
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
@@ -68,11 +70,11 @@ static void swap2d_element_based(Mesh* mesh, AdaptOpts const& opts) {
   *mesh = new_mesh;
 }
 
-bool swap_edges_2d(Mesh* mesh, AdaptOpts const& opts) {
+bool swap_edges_2d(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   if (!swap_part1(mesh, opts)) return false;
   if (!swap2d_ghosted(mesh, opts)) return false;
   mesh->set_parting(OMEGA_H_ELEM_BASED);
-  swap2d_element_based(mesh, opts);
+  swap2d_element_based(mesh, opts, stats);
   return true;
 }
 
@@ -12,59 +12,81 @@ namespace Omega_h {
    vertices, edge length overshooting is also handled
    by the qualities function */
 
+/* the cavity of swapping candidate edge (cand): the two triangles
+   formed by the other diagonal of its quadrilateral */
 template <Int metric_dim>
-static Reals swap2d_qualities_tmpl(
-    Mesh* mesh, AdaptOpts const& opts, LOs cands2edges) {
-  auto e2t = mesh->ask_up(EDGE, TRI);
-  auto e2et = e2t.a2ab;
-  auto et2t = e2t.ab2b;
-  auto et_codes = e2t.codes;
-  auto edge_verts2verts = mesh->ask_verts_of(EDGE);
-  auto tri_verts2verts = mesh->ask_verts_of(TRI);
-  auto edges_are_owned = mesh->owned(EDGE);
-  auto quality_measure = MetricElementQualities<2, metric_dim>(mesh);
-  auto length_measure = MetricEdgeLengths<2, metric_dim>(mesh);
-  auto max_length = opts.max_length_allowed;
-  auto ncands = cands2edges.size();
-  auto cand_quals_w = Write<Real>(ncands);
-  auto f = OMEGA_H_LAMBDA(LO cand) {
-    auto edge = cands2edges[cand];
-    /* non-owned edges will have incomplete cavities
-       and will run into the topological assertions
-       in find_loop(). don't bother; their results
-       will be overwritten by the owner's anyways */
-    if (!edges_are_owned[edge]) {
-      cand_quals_w[cand] = -1.0;
-      return;
-    }
+struct Swap2dCavities {
+  MetricElementQualities<2, metric_dim> quality_measure;
+  MetricEdgeLengths<2, metric_dim> length_measure;
+  LOs cands2edges;
+  LOs e2et;
+  LOs et2t;
+  Read<I8> et_codes;
+  LOs edge_verts2verts;
+  LOs tri_verts2verts;
+  Read<I8> edges_are_owned;
+  Real max_length;
+  Swap2dCavities(Mesh* mesh, AdaptOpts const& opts, LOs cands2edges_)
+      : quality_measure(mesh),
+        length_measure(mesh),
+        cands2edges(cands2edges_),
+        edge_verts2verts(mesh->ask_verts_of(EDGE)),
+        tri_verts2verts(mesh->ask_verts_of(TRI)),
+        edges_are_owned(mesh->owned(EDGE)),
+        max_length(opts.max_length_allowed) {
+    auto e2t = mesh->ask_up(EDGE, TRI);
+    e2et = e2t.a2ab;
+    et2t = e2t.ab2b;
+    et_codes = e2t.codes;
+  }
+  /* the vertices opposite to the edge, ordered by rotation */
+  OMEGA_H_DEVICE Few<LO, 2> opposite_verts(LO edge) const {
     OMEGA_H_CHECK(e2et[edge + 1] == 2 + e2et[edge]);
-    LO t[2];
     Few<LO, 2> ov;
     for (Int i = 0; i < 2; ++i) {
       auto et = e2et[edge] + i;
       auto code = et_codes[et];
       auto tte = code_which_down(code);
       auto rot = code_rotation(code);
-      t[rot] = et2t[et];
+      auto t = et2t[et];
       auto ttv = opposite_template(TRI, EDGE, tte);
-      ov[rot] = tri_verts2verts[t[rot] * 3 + ttv];
-    }
-    auto l = length_measure.measure(ov);
-    if (l > max_length) {
-      cand_quals_w[cand] = -1.0;
-      return;
+      ov[rot] = tri_verts2verts[t * 3 + ttv];
     }
+    return ov;
+  }
+  OMEGA_H_DEVICE Int count(LO cand) const {
+    auto edge = cands2edges[cand];
+    /* non-owned edges will have incomplete cavities
+       and will run into the topological assertions
+       in opposite_verts(). don't bother; their results
+       will be overwritten by the owner's anyways */
+    if (!edges_are_owned[edge]) return -1;
+    auto l = length_measure.measure(opposite_verts(edge));
+    if (l > max_length) return -1;
+    return 2;
+  }
+  OMEGA_H_DEVICE bool get(LO cand, Int i, Few<Vector<2>, 3>* p,
+      Few<Matrix<metric_dim, metric_dim>, 3>* ms) const {
+    auto edge = cands2edges[cand];
+    auto ov = opposite_verts(edge);
     auto ev = gather_verts<2>(edge_verts2verts, edge);
-    Real minqual = 1.0;
-    for (Int i = 0; i < 2; ++i) {
-      Few<LO, 3> ntv;
-      ntv[0] = ev[1 - i];
-      ntv[1] = ov[i];
-      ntv[2] = ov[1 - i];
-      auto qual = quality_measure.measure(ntv);
-      minqual = min2(minqual, qual);
-    }
-    cand_quals_w[cand] = minqual;
+    Few<LO, 3> ntv;
+    ntv[0] = ev[1 - i];
+    ntv[1] = ov[i];
+    ntv[2] = ov[1 - i];
+    quality_measure.gather(ntv, p, ms);
+    return true;
+  }
+};
+
+template <Int metric_dim>
+static Reals swap2d_qualities_tmpl(
+    Mesh* mesh, AdaptOpts const& opts, LOs cands2edges) {
+  auto cavities = Swap2dCavities<metric_dim>(mesh, opts, cands2edges);
+  auto ncands = cands2edges.size();
+  auto cand_quals_w = Write<Real>(ncands);
+  auto f = OMEGA_H_LAMBDA(LO cand) {
+    cand_quals_w[cand] = cavity_min_quality<2, metric_dim>(cavities, cand);
   };
   parallel_for(ncands, f, "swap2d_qualities");
   auto cand_quals = Reals(cand_quals_w);
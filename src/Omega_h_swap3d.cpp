@@ -36,13 +36,15 @@ static bool swap3d_ghosted(Mesh* mesh, AdaptOpts const& opts) {
   return true;
 }
 
-static void swap3d_element_based(Mesh* mesh, AdaptOpts const& opts) {
+static void swap3d_element_based(
+    Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   auto comm = mesh->comm();
   auto edges_are_keys = mesh->get_array<I8>(EDGE, "key");
   mesh->remove_tag(EDGE, "key");
   auto edges_configs = mesh->get_array<I8>(EDGE, "config");
   mesh->remove_tag(EDGE, "config");
   auto keys2edges = collect_marked(edges_are_keys);
+  if (stats) stats->nswapped_edges += keys2edges.size();
   if (opts.verbosity >= EACH_REBUILD) {
     auto nkeys = keys2edges.size();
     auto ntotal_keys = comm->allreduce(GO(nkeys), OMEGA_H_SUM);
@@ -74,11 +76,11 @@ static void swap3d_element_based(Mesh* mesh, AdaptOpts const& opts) {
   *mesh = new_mesh;
 }
 
-bool swap_edges_3d(Mesh* mesh, AdaptOpts const& opts) {
+bool swap_edges_3d(Mesh* mesh, AdaptOpts const& opts, AdaptStats* stats) {
   if (!swap_part1(mesh, opts)) return false;
   if (!swap3d_ghosted(mesh, opts)) return false;
   mesh->set_parting(OMEGA_H_ELEM_BASED, false);
-  swap3d_element_based(mesh, opts);
+  swap3d_element_based(mesh, opts, stats);
   return true;
 }
 
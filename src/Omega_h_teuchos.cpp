@@ -127,12 +127,20 @@ void update_adapt_opts(AdaptOpts* opts, Teuchos::ParameterList const& pl) {
 #endif
   set_if_given(&opts->max_motion_steps, pl, "Max Motion Steps");
   set_if_given(&opts->motion_step_size, pl, "Motion Step Size");
+  set_if_given(&opts->should_move_with_gradient, pl, "Move With Gradient");
   set_if_given(&opts->should_refine, pl, "Refine");
+  set_if_given(
+      &opts->should_refine_with_templates, pl, "Refine With Templates");
+  set_if_given(&opts->should_store_log_metric, pl, "Store Log Metric");
+  set_if_given(
+      &opts->should_cache_mident_metrics, pl, "Cache Midpoint Metrics");
   set_if_given(&opts->should_coarsen, pl, "Coarsen");
   set_if_given(&opts->should_swap, pl, "Swap");
   set_if_given(&opts->should_coarsen_slivers, pl, "Coarsen Slivers");
   set_if_given(&opts->should_move_for_quality, pl, "Move For Quality");
   set_if_given(&opts->should_allow_pinching, pl, "Allow Pinching");
+  set_if_given(&opts->max_time, pl, "Max Time");
+  set_if_given(&opts->max_rebuilds, pl, "Max Rebuilds");
   if (pl.isSublist("Transfer")) {
     update_transfer_opts(&opts->xfer_opts, pl.sublist("Transfer"));
   }
@@ -209,6 +217,8 @@ void update_metric_input(MetricInput* input, Teuchos::ParameterList const& pl) {
   set_if_given(&input->min_element_count, pl, "Min Element Count");
   set_if_given(&input->element_count_over_relaxation, pl,
       "Element Count Over-Relaxation");
+  set_if_given(&input->should_scale_element_count_in_closed_form, pl,
+      "Closed-Form Element Count");
   input->nsmoothing_steps = 0;
   set_if_given(&input->nsmoothing_steps, pl, "Smoothing Step Count");
 }
@@ -1,5 +1,7 @@
 #include "Omega_h_transfer.hpp"
 
+#include <vector>
+
 #include "Omega_h_conserve.hpp"
 #include "Omega_h_control.hpp"
 #include "Omega_h_fit.hpp"
@@ -84,6 +86,11 @@ bool is_metric(
          (tag->ncomps() == symm_ncomps(mesh->dim()) || tag->ncomps() == 1);
 }
 
+bool is_log_metric(Int dim, TagBase const* tag) {
+  return dim == VERT && tag->name() == "log_metric" &&
+         tag->type() == OMEGA_H_REAL;
+}
+
 bool is_momentum_velocity(
     Mesh* mesh, TransferOpts const& opts, Int dim, TagBase const* tag) {
   auto& name = tag->name();
@@ -107,7 +114,7 @@ static bool should_transfer_no_products(
     Mesh* mesh, TransferOpts const& opts, Int dim, TagBase const* tag) {
   return should_inherit(mesh, opts, dim, tag) ||
          should_interpolate(mesh, opts, dim, tag) ||
-         is_metric(mesh, opts, dim, tag) ||
+         is_metric(mesh, opts, dim, tag) || is_log_metric(dim, tag) ||
          should_conserve(mesh, opts, dim, tag) ||
          is_momentum_velocity(mesh, opts, dim, tag);
 }
@@ -150,6 +157,86 @@ void transfer_common(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
       same_ents2new_ents, tagbase, new_data);
 }
 
+/* the real tags of one dimension that share a transfer policy
+   can be packed into one interleaved array, so that a transfer
+   whose kernel does work beyond copying (e.g. point location)
+   does it once for all of them instead of once per tag.
+   a pack of one tag uses the tag's array as is. */
+
+typedef bool (*TransferPolicy)(
+    Mesh* mesh, TransferOpts const& opts, Int dim, TagBase const* tag);
+
+struct TagPack {
+  std::vector<TagBase const*> tags;
+  Int ncomps;
+};
+
+static TagPack get_tag_pack(
+    Mesh* mesh, TransferOpts const& opts, Int dim, TransferPolicy policy) {
+  TagPack pack;
+  pack.ncomps = 0;
+  for (Int i = 0; i < mesh->ntags(dim); ++i) {
+    auto tagbase = mesh->get_tag(dim, i);
+    if (policy(mesh, opts, dim, tagbase)) {
+      OMEGA_H_CHECK(tagbase->type() == OMEGA_H_REAL);
+      pack.tags.push_back(tagbase);
+      pack.ncomps += tagbase->ncomps();
+    }
+  }
+  return pack;
+}
+
+static Reals pack_tags(Mesh* mesh, Int dim, TagPack const& pack) {
+  if (pack.tags.size() == 1) {
+    return mesh->get_array<Real>(dim, pack.tags[0]->name());
+  }
+  auto ncomps = pack.ncomps;
+  auto out = Write<Real>(mesh->nents(dim) * ncomps);
+  Int offset = 0;
+  for (auto tagbase : pack.tags) {
+    auto in = mesh->get_array<Real>(dim, tagbase->name());
+    auto ncomps_in = tagbase->ncomps();
+    auto f = OMEGA_H_LAMBDA(LO i) {
+      for (Int c = 0; c < ncomps_in; ++c) {
+        out[i * ncomps + offset + c] = in[i * ncomps_in + c];
+      }
+    };
+    parallel_for(mesh->nents(dim), f, "pack_tags");
+    offset += ncomps_in;
+  }
+  return out;
+}
+
+/* the packed version of transfer_common() */
+static void transfer_common_pack(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    LOs same_ents2old_ents, LOs same_ents2new_ents, LOs prods2new_ents,
+    TagPack const& pack, Reals old_data, Reals prod_data) {
+  if (pack.tags.size() == 1) {
+    transfer_common(old_mesh, new_mesh, ent_dim, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents, pack.tags[0], prod_data);
+    return;
+  }
+  auto nnew_ents = new_mesh->nents(ent_dim);
+  auto ncomps = pack.ncomps;
+  auto new_data = Write<Real>(nnew_ents * ncomps);
+  map_into(prod_data, prods2new_ents, new_data, ncomps);
+  auto same_data = unmap(same_ents2old_ents, old_data, ncomps);
+  map_into(same_data, same_ents2new_ents, new_data, ncomps);
+  Int offset = 0;
+  for (auto tagbase : pack.tags) {
+    auto ncomps_out = tagbase->ncomps();
+    auto out = Write<Real>(nnew_ents * ncomps_out);
+    auto f = OMEGA_H_LAMBDA(LO i) {
+      for (Int c = 0; c < ncomps_out; ++c) {
+        out[i * ncomps_out + c] = new_data[i * ncomps + offset + c];
+      }
+    };
+    parallel_for(nnew_ents, f, "unpack_tags");
+    transfer_common3(new_mesh, ent_dim, tagbase, out);
+    offset += ncomps_out;
+  }
+}
+
 static void transfer_linear_interp(Mesh* old_mesh, TransferOpts const& opts,
     Mesh* new_mesh, LOs keys2edges, LOs keys2midverts, LOs same_verts2old_verts,
     LOs same_verts2new_verts) {
@@ -169,17 +256,45 @@ static void transfer_linear_interp(Mesh* old_mesh, TransferOpts const& opts,
 static void transfer_metric(Mesh* old_mesh, TransferOpts const& opts,
     Mesh* new_mesh, LOs keys2edges, LOs keys2midverts, LOs same_verts2old_verts,
     LOs same_verts2new_verts) {
+  auto has_log = old_mesh->has_tag(VERT, "log_metric");
   for (Int i = 0; i < old_mesh->ntags(VERT); ++i) {
     auto tagbase = old_mesh->get_tag(VERT, i);
+    /* see transfer_log_metric */
+    if (has_log && tagbase->name() == "metric") continue;
     if (is_metric(old_mesh, opts, VERT, tagbase)) {
       auto old_data = old_mesh->get_array<Real>(VERT, tagbase->name());
-      auto prod_data = get_mident_metrics(old_mesh, EDGE, keys2edges, old_data);
+      auto prod_data = (tagbase->name() == "metric")
+                           ? get_mident_metrics(old_mesh, EDGE, keys2edges)
+                           : get_mident_metrics(
+                                 old_mesh, EDGE, keys2edges, old_data);
       transfer_common(old_mesh, new_mesh, VERT, same_verts2old_verts,
           same_verts2new_verts, keys2midverts, tagbase, prod_data);
     }
   }
 }
 
+/* with "log_metric" present, the midpoint metrics are exponentials
+   of plain averages, and the averages become the new "log_metric" */
+static void transfer_log_metric(Mesh* old_mesh, Mesh* new_mesh,
+    LOs keys2edges, LOs keys2midverts, LOs same_verts2old_verts,
+    LOs same_verts2new_verts) {
+  auto tagbase = old_mesh->get_tagbase(VERT, "log_metric");
+  auto ncomps = tagbase->ncomps();
+  auto old_data = old_mesh->get_array<Real>(VERT, "log_metric");
+  auto prod_data = average_field(old_mesh, EDGE, keys2edges, ncomps, old_data);
+  transfer_common(old_mesh, new_mesh, VERT, same_verts2old_verts,
+      same_verts2new_verts, keys2midverts, tagbase, prod_data);
+  auto prod_metrics = Reals({});
+  if (old_mesh->has_tag(EDGE, "mident_metric")) {
+    prod_metrics = get_mident_metrics(old_mesh, EDGE, keys2edges);
+  } else if (keys2edges.size()) {
+    prod_metrics = delinearize_metrics(keys2edges.size(), prod_data);
+  }
+  transfer_common(old_mesh, new_mesh, VERT, same_verts2old_verts,
+      same_verts2new_verts, keys2midverts,
+      old_mesh->get_tagbase(VERT, "metric"), prod_metrics);
+}
+
 template <typename T>
 void transfer_inherit_refine(Mesh* old_mesh, Mesh* new_mesh, LOs keys2edges,
     Int prod_dim, LOs keys2prods, LOs prods2new_ents, LOs same_ents2old_ents,
@@ -290,6 +405,86 @@ static void transfer_pointwise_refine(Mesh* old_mesh, TransferOpts const& opts,
   }
 }
 
+template <typename T>
+static void transfer_inherit_refine_templates(Mesh* old_mesh,
+    Mesh* new_mesh, Int prod_dim, Read<I8> prods2parent_dims,
+    LOs prods2parents, LOs prods2new_ents, LOs same_ents2old_ents,
+    LOs same_ents2new_ents, TagBase const* tagbase) {
+  auto const& name = tagbase->name();
+  auto ncomps = tagbase->ncomps();
+  auto nprods = prods2parents.size();
+  auto prod_data = Write<T>(nprods * ncomps);
+  for (Int parent_dim = prod_dim; parent_dim <= old_mesh->dim();
+       ++parent_dim) {
+    if (!old_mesh->has_tag(parent_dim, name)) continue;
+    auto parent_data = old_mesh->get_array<T>(parent_dim, name);
+    auto f = OMEGA_H_LAMBDA(LO prod) {
+      if (prods2parent_dims[prod] != parent_dim) return;
+      auto parent = prods2parents[prod];
+      for (Int comp = 0; comp < ncomps; ++comp) {
+        prod_data[prod * ncomps + comp] = parent_data[parent * ncomps + comp];
+      }
+    };
+    parallel_for(nprods, f, "transfer_inherit_refine_templates");
+  }
+  transfer_common(old_mesh, new_mesh, prod_dim, same_ents2old_ents,
+      same_ents2new_ents, prods2new_ents, tagbase, Read<T>(prod_data));
+}
+
+/* template refinement only runs when nothing needs to be conserved,
+   so every product either inherits from the old entity containing it
+   or is measured anew */
+void transfer_refine_templates(Mesh* old_mesh, TransferOpts const& opts,
+    Mesh* new_mesh, Int prod_dim, Read<I8> prods2parent_dims,
+    LOs prods2parents, LOs prods2new_ents, LOs same_ents2old_ents,
+    LOs same_ents2new_ents) {
+  auto t0 = now();
+  auto dim = old_mesh->dim();
+  for (Int i = 0; i < old_mesh->ntags(prod_dim); ++i) {
+    auto tagbase = old_mesh->get_tag(prod_dim, i);
+    if (!(should_inherit(old_mesh, opts, prod_dim, tagbase) ||
+            should_fit(old_mesh, opts, prod_dim, tagbase))) {
+      continue;
+    }
+    switch (tagbase->type()) {
+      case OMEGA_H_I8:
+        transfer_inherit_refine_templates<I8>(old_mesh, new_mesh, prod_dim,
+            prods2parent_dims, prods2parents, prods2new_ents,
+            same_ents2old_ents, same_ents2new_ents, tagbase);
+        break;
+      case OMEGA_H_I32:
+        transfer_inherit_refine_templates<I32>(old_mesh, new_mesh, prod_dim,
+            prods2parent_dims, prods2parents, prods2new_ents,
+            same_ents2old_ents, same_ents2new_ents, tagbase);
+        break;
+      case OMEGA_H_I64:
+        transfer_inherit_refine_templates<I64>(old_mesh, new_mesh, prod_dim,
+            prods2parent_dims, prods2parents, prods2new_ents,
+            same_ents2old_ents, same_ents2new_ents, tagbase);
+        break;
+      case OMEGA_H_F64:
+        transfer_inherit_refine_templates<Real>(old_mesh, new_mesh, prod_dim,
+            prods2parent_dims, prods2parents, prods2new_ents,
+            same_ents2old_ents, same_ents2new_ents, tagbase);
+        break;
+    }
+  }
+  if (prod_dim == EDGE) {
+    transfer_length(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
+        prods2new_ents);
+    transfer_mident_metric(old_mesh, new_mesh, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents);
+  }
+  if (prod_dim == dim) {
+    transfer_size(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
+        prods2new_ents);
+    transfer_quality(old_mesh, new_mesh, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents);
+  }
+  auto t1 = now();
+  add_to_global_timer("transferring", t1 - t0);
+}
+
 void transfer_length(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs prods2new_ents) {
   for (Int i = 0; i < old_mesh->ntags(EDGE); ++i) {
@@ -303,6 +498,15 @@ void transfer_length(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
   }
 }
 
+void transfer_mident_metric(Mesh* old_mesh, Mesh* new_mesh,
+    LOs same_ents2old_ents, LOs same_ents2new_ents, LOs prods2new_ents) {
+  if (!old_mesh->has_tag(EDGE, "mident_metric")) return;
+  auto tagbase = old_mesh->get_tagbase(EDGE, "mident_metric");
+  auto prod_data = get_mident_metrics(new_mesh, EDGE, prods2new_ents);
+  transfer_common(old_mesh, new_mesh, EDGE, same_ents2old_ents,
+      same_ents2new_ents, prods2new_ents, tagbase, prod_data);
+}
+
 void transfer_quality(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs prods2new_ents) {
   auto dim = old_mesh->dim();
@@ -342,10 +546,16 @@ void transfer_refine(Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh,
         same_ents2old_ents, same_ents2new_ents);
     transfer_metric(old_mesh, opts, new_mesh, keys2edges, keys2midverts,
         same_ents2old_ents, same_ents2new_ents);
+    if (old_mesh->has_tag(VERT, "log_metric")) {
+      transfer_log_metric(old_mesh, new_mesh, keys2edges, keys2midverts,
+          same_ents2old_ents, same_ents2new_ents);
+    }
   }
   if (prod_dim == EDGE) {
     transfer_length(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
         prods2new_ents);
+    transfer_mident_metric(old_mesh, new_mesh, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents);
   }
   if (prod_dim == old_mesh->dim()) {
     transfer_size(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
@@ -449,11 +659,9 @@ static void transfer_no_products(Mesh* old_mesh, TransferOpts const& opts,
 template <Int dim>
 static void transfer_pointwise_tmpl(Mesh* old_mesh, Mesh* new_mesh, Int key_dim,
     LOs keys2kds, LOs keys2prods, LOs prods2new_elems, LOs same_elems2old_elems,
-    LOs same_elems2new_elems, TagBase const* tagbase) {
-  auto name = tagbase->name();
-  auto old_tag = as<Real>(tagbase);
-  auto ncomps = old_tag->ncomps();
-  auto old_data = old_tag->array();
+    LOs same_elems2new_elems, TagPack const& pack) {
+  auto ncomps = pack.ncomps;
+  auto old_data = pack_tags(old_mesh, dim, pack);
   auto kds2elems = old_mesh->ask_up(key_dim, dim);
   auto kds2kd_elems = kds2elems.a2ab;
   auto kd_elems2elems = kds2elems.ab2b;
@@ -495,27 +703,25 @@ static void transfer_pointwise_tmpl(Mesh* old_mesh, Mesh* new_mesh, Int key_dim,
   };
   parallel_for(nkeys, f, "transfer_pointwise");
   auto prod_data = Reals(prod_data_w);
-  transfer_common(old_mesh, new_mesh, dim, same_elems2old_elems,
-      same_elems2new_elems, prods2new_elems, old_tag, prod_data);
+  transfer_common_pack(old_mesh, new_mesh, dim, same_elems2old_elems,
+      same_elems2new_elems, prods2new_elems, pack, old_data, prod_data);
 }
 
 void transfer_pointwise(Mesh* old_mesh, TransferOpts const& opts,
     Mesh* new_mesh, Int key_dim, LOs keys2kds, LOs keys2prods,
     LOs prods2new_ents, LOs same_ents2old_ents, LOs same_ents2new_ents) {
   auto dim = new_mesh->dim();
-  for (Int i = 0; i < old_mesh->ntags(dim); ++i) {
-    auto tagbase = old_mesh->get_tag(dim, i);
-    if (should_fit(old_mesh, opts, dim, tagbase)) {
-      if (dim == 3) {
-        transfer_pointwise_tmpl<3>(old_mesh, new_mesh, key_dim, keys2kds,
-            keys2prods, prods2new_ents, same_ents2old_ents, same_ents2new_ents,
-            tagbase);
-      } else if (dim == 2) {
-        transfer_pointwise_tmpl<2>(old_mesh, new_mesh, key_dim, keys2kds,
-            keys2prods, prods2new_ents, same_ents2old_ents, same_ents2new_ents,
-            tagbase);
-      }
-    }
+  /* all fitted tags share the location of each product */
+  auto pack = get_tag_pack(old_mesh, opts, dim, should_fit);
+  if (pack.tags.empty()) return;
+  if (dim == 3) {
+    transfer_pointwise_tmpl<3>(old_mesh, new_mesh, key_dim, keys2kds,
+        keys2prods, prods2new_ents, same_ents2old_ents, same_ents2new_ents,
+        pack);
+  } else if (dim == 2) {
+    transfer_pointwise_tmpl<2>(old_mesh, new_mesh, key_dim, keys2kds,
+        keys2prods, prods2new_ents, same_ents2old_ents, same_ents2new_ents,
+        pack);
   }
 }
 
@@ -533,6 +739,8 @@ void transfer_coarsen(Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh,
   if (prod_dim == EDGE) {
     transfer_length(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
         prods2new_ents);
+    transfer_mident_metric(old_mesh, new_mesh, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents);
   }
   if (prod_dim == old_mesh->dim()) {
     transfer_size(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
@@ -652,6 +860,8 @@ void transfer_swap(Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh,
   if (prod_dim == EDGE) {
     transfer_length(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
         prods2new_ents);
+    transfer_mident_metric(old_mesh, new_mesh, same_ents2old_ents,
+        same_ents2new_ents, prods2new_ents);
   }
   if (prod_dim == old_mesh->dim()) {
     transfer_size(old_mesh, new_mesh, same_ents2old_ents, same_ents2new_ents,
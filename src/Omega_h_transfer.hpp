@@ -1,6 +1,8 @@
 #ifndef OMEGA_H_TRANSFER_HPP
 #define OMEGA_H_TRANSFER_HPP
 
+#include <functional>
+
 #include <Omega_h_adapt.hpp>
 #include <Omega_h_adj.hpp>
 #include <Omega_h_tag.hpp>
@@ -21,6 +23,7 @@ bool should_conserve(
 bool should_conserve_any(Mesh* mesh, TransferOpts const& opts);
 bool is_metric(
     Mesh* mesh, TransferOpts const& opts, Int dim, TagBase const* tag);
+bool is_log_metric(Int dim, TagBase const* tag);
 bool is_momentum_velocity(
     Mesh* mesh, TransferOpts const& opts, Int dim, TagBase const* tag);
 bool has_momentum_velocity(Mesh* mesh, TransferOpts const& opts);
@@ -33,6 +36,11 @@ void transfer_inherit_refine(Mesh* old_mesh, Mesh* new_mesh, LOs keys2edges,
     Int prod_dim, LOs keys2prods, LOs prods2new_ents, LOs same_ents2old_ents,
     LOs same_ents2new_ents, TagBase const* tagbase);
 
+void transfer_refine_templates(Mesh* old_mesh, TransferOpts const& opts,
+    Mesh* new_mesh, Int prod_dim, Read<I8> prods2parent_dims,
+    LOs prods2parents, LOs prods2new_ents, LOs same_ents2old_ents,
+    LOs same_ents2new_ents);
+
 void transfer_coarsen(Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh,
     LOs keys2verts, Adj keys2doms, Int prod_dim, LOs prods2new_ents,
     LOs same_ents2old_ents, LOs same_ents2new_ents);
@@ -66,6 +74,8 @@ void transfer_inherit_refine(Mesh* old_mesh, Mesh* new_mesh, LOs keys2edges,
 
 void transfer_length(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs prods2new_ents);
+void transfer_mident_metric(Mesh* old_mesh, Mesh* new_mesh,
+    LOs same_ents2old_ents, LOs same_ents2new_ents, LOs prods2new_ents);
 void transfer_quality(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
     LOs same_ents2new_ents, LOs prods2new_ents);
 void transfer_size(Mesh* old_mesh, Mesh* new_mesh, LOs same_ents2old_ents,
@@ -3,6 +3,8 @@
 #include "Omega_h_bipart.hpp"
 #include "Omega_h_compare.hpp"
 #include "Omega_h_inertia.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_motion.hpp"
 #include "Omega_h_owners.hpp"
 #include "Omega_h_vtk.hpp"
 
@@ -27,6 +29,47 @@ static void test_one_rank(CommPtr comm) {
     Read<GO> a({0, 1, 2, 3});
     auto b = dist.exch(a, 1);
     OMEGA_H_CHECK(b == Read<GO>({3, 2, 1, 0}));
+    OMEGA_H_CHECK(dist.exch_begin(a, 1).get() == b);
+    Future<LO> items;
+    auto values =
+        dist.exch_subset_begin(Read<I8>({0, 1, 0, 1}), a, 1, &items);
+    OMEGA_H_CHECK(values.get() == Read<GO>({1, 3}));
+    OMEGA_H_CHECK(items.get() == LOs({2, 0}));
+    auto c = Reals({0., 1., 2., 3., 4., 5., 6., 7.});
+    auto d = Read<I8>({1, 2, 3, 4});
+    ExchBatch batch;
+    batch.add(&a, 1);
+    batch.add(&c, 2);
+    batch.add(&d, 1);
+    batch.exch(dist);
+    OMEGA_H_CHECK(a == b);
+    OMEGA_H_CHECK(c == Reals({6., 7., 4., 5., 2., 3., 0., 1.}));
+    OMEGA_H_CHECK(d == Read<I8>({4, 3, 2, 1}));
+  }
+  {  // the compressed wire format, used for every message here
+    auto lib = comm->library();
+    auto old_threshold = lib->compress_threshold_;
+    lib->compress_threshold_ = 1;
+    LO n = 100;
+    Dist dist;
+    dist.set_parent_comm(comm);
+    dist.set_dest_ranks(Read<I32>(n, 0));
+    dist.set_dest_idxs(LOs(n, n - 1, -1), n);
+    auto a = Read<GO>(n, -(GO(1) << 40), GO(1) << 33);
+    OMEGA_H_CHECK(dist.exch(a, 1) == Read<GO>(n, a.last(), -(GO(1) << 33)));
+    auto b = LOs(n, 7);
+    OMEGA_H_CHECK(dist.exch(b, 1) == b);
+    auto c = Read<Real>(n, 0.5, 0.25);
+    auto reversed_c = Read<Real>(n, c.last(), -0.25);
+    OMEGA_H_CHECK(dist.exch(c, 1) == reversed_c);
+    auto d = Read<I8>(n, 3);
+    ExchBatch batch;
+    batch.add(&c, 1);
+    batch.add(&d, 1);
+    batch.exch(dist);
+    OMEGA_H_CHECK(c == reversed_c);
+    OMEGA_H_CHECK(d == Read<I8>(n, 3));
+    lib->compress_threshold_ = old_threshold;
   }
 }
 
@@ -58,6 +101,23 @@ static void test_two_ranks_dist(CommPtr comm) {
   }
   auto c = dist.invert().exch(b, 1);
   OMEGA_H_CHECK(c == a);
+  auto b_future = dist.exch_begin(a, 1);
+  auto c_future = dist.exch_begin(Reals(a.size(), 7.), 1);
+  OMEGA_H_CHECK(b_future.get() == b);
+  OMEGA_H_CHECK(c_future.get() == Reals(b.size(), 7.));
+  /* only roots 0 and 2 of rank 0 and root 1 of rank 1 */
+  Future<LO> items;
+  auto roots_are_sent =
+      (comm->rank() == 0) ? Read<I8>({1, 0, 1}) : Read<I8>({0, 1});
+  auto values = dist.exch_subset_begin(roots_are_sent, a, 1, &items);
+  Write<Real> d(b.size(), -1.);
+  auto recvd2items = items.get();
+  map_into(values.get(), recvd2items, d, 1);
+  if (comm->rank() == 0) {
+    OMEGA_H_CHECK(Reals(d) == Reals({4., -1., 2.}));
+  } else {
+    OMEGA_H_CHECK(Reals(d) == Reals({-1., 0.}));
+  }
 }
 
 static void test_two_ranks_eq_owners(CommPtr comm) {
@@ -140,6 +200,29 @@ static void test_two_ranks_exch_sum(CommPtr comm) {
   }
 }
 
+static void test_two_ranks_reduce_batch(CommPtr comm) {
+  auto rank = comm->rank();
+  I8 all = I8(rank == 0);
+  I32 count = 3 + rank;
+  GO big = (GO(1) << 40) * (rank + 1);
+  Real least = 0.5 - rank;
+  Real most = 0.5 - rank;
+  ReduceBatch batch;
+  batch.add(&all, OMEGA_H_MIN);
+  batch.add(&count, OMEGA_H_SUM);
+  batch.add(&big, OMEGA_H_MAX);
+  batch.add(&least, OMEGA_H_MIN);
+  batch.add(&most, OMEGA_H_MAX);
+  batch.allreduce(comm);
+  OMEGA_H_CHECK(all == 0);
+  OMEGA_H_CHECK(count == 7);
+  OMEGA_H_CHECK(big == (GO(1) << 41));
+  OMEGA_H_CHECK(least == -0.5);
+  OMEGA_H_CHECK(most == 0.5);
+  auto minmax = get_minmax(comm, LOs({rank, 2 * rank + 1}));
+  OMEGA_H_CHECK(minmax.min == 0 && minmax.max == 3);
+}
+
 static void test_two_ranks_owners(CommPtr comm) {
   test_two_ranks_eq_owners(comm);
   test_two_ranks_uneq_owners(comm);
@@ -218,15 +301,31 @@ static void test_binary_io(Library* lib, CommPtr comm) {
       OMEGA_H_SAME == compare_meshes(&mesh0, &mesh2, opts, true, true));
 }
 
+static void test_ghost_round_trip(CommPtr comm) {
+  auto mesh0 = build_box(comm, 1., 1., 0., 4, 4, 0);
+  mesh0.set_parting(OMEGA_H_ELEM_BASED);
+  auto mesh1 = mesh0;
+  mesh1.set_parting(OMEGA_H_GHOSTED);
+  mesh1.set_parting(OMEGA_H_ELEM_BASED);
+  OMEGA_H_CHECK(mesh0 == mesh1);
+  for (Int d = 0; d <= mesh0.dim(); ++d) {
+    OMEGA_H_CHECK(mesh0.globals(d) == mesh1.globals(d));
+    OMEGA_H_CHECK(mesh0.ask_owners(d).ranks == mesh1.ask_owners(d).ranks);
+    OMEGA_H_CHECK(mesh0.ask_owners(d).idxs == mesh1.ask_owners(d).idxs);
+  }
+}
+
 static void test_two_ranks(Library* lib, CommPtr comm) {
   test_two_ranks_dist(comm);
   test_two_ranks_owners(comm);
   test_two_ranks_bipart(comm);
   test_two_ranks_exch_sum(comm);
+  test_two_ranks_reduce_batch(comm);
   test_resolve_derived(comm);
   test_construct(lib, comm);
   test_read_vtu(lib, comm);
   test_binary_io(lib, comm);
+  test_ghost_round_trip(comm);
 }
 
 static void test_rib(CommPtr comm) {
@@ -259,6 +358,59 @@ static void test_rib(CommPtr comm) {
   OMEGA_H_CHECK(masses == Reals(n, 1));
 }
 
+/* builds a box with perturbed interior vertices, ghosts it and
+   moves vertices for quality twice, which should keep the ghost
+   layer. returns the sum of the owned vertex coordinates */
+static Real move_perturbed_box(CommPtr comm) {
+  auto mesh = build_box(comm, 1., 1., 1., 4, 4, 4);
+  auto coords = mesh.coords();
+  auto class_dims = mesh.get_array<I8>(VERT, "class_dim");
+  Write<Real> new_coords(coords.size());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<3>(coords, v);
+    auto y = x;
+    if (class_dims[v] == 3) {
+      y[0] += 0.05 * sin(17.0 * x[1] + 3.0 * x[2]);
+      y[1] += 0.05 * sin(13.0 * x[2] + 5.0 * x[0]);
+      y[2] += 0.05 * sin(11.0 * x[0] + 7.0 * x[1]);
+    }
+    set_vector(new_coords, v, y);
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.set_coords(Reals(new_coords));
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  add_implied_metric_tag(&mesh);
+  auto opts = AdaptOpts(&mesh);
+  opts.min_quality_desired = 0.8;
+  opts.verbosity = SILENT;
+  OMEGA_H_CHECK(move_verts_for_quality(&mesh, opts));
+  OMEGA_H_CHECK(move_verts_for_quality(&mesh, opts));
+  OMEGA_H_CHECK(mesh.parting() == OMEGA_H_GHOSTED);
+  return repro_sum(comm, mesh.owned_array(VERT, mesh.coords(), 3));
+}
+
+#ifndef OMEGA_H_USE_MPI
+/* builds, balances, ghosts and adapts a square,
+   returning the global number of resulting triangles */
+static GO adapt_square(CommPtr comm) {
+  auto mesh = build_box(comm, 1., 1., 0., 4, 4, 0);
+  if (comm->size() > 1) {
+    OMEGA_H_CHECK(mesh.nelems() < mesh.nglobal_ents(TRI));
+  }
+  auto nglobal_elems = mesh.nglobal_ents(TRI);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  OMEGA_H_CHECK(mesh.nglobal_ents(TRI) == nglobal_elems);
+  mesh.add_tag(VERT, "metric", 1,
+      Reals(mesh.nverts(), metric_eigenvalue_from_length(0.1)));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  adapt(&mesh, opts);
+  OMEGA_H_CHECK(mesh.nglobal_ents(TRI) > nglobal_elems);
+  OMEGA_H_CHECK(mesh.min_quality() >= opts.min_quality_allowed);
+  return mesh.nglobal_ents(TRI);
+}
+#endif
+
 int main(int argc, char** argv) {
   auto lib = Library(&argc, &argv);
   auto world = lib.world();
@@ -276,6 +428,18 @@ int main(int argc, char** argv) {
       test_two_ranks(&lib, two);
     }
   }
+#ifndef OMEGA_H_USE_MPI
+  auto nserial_elems = adapt_square(lib.self());
+  auto serial_coord_sum = move_perturbed_box(lib.self());
+  run_on_threads(&lib, 4, [&](CommPtr comm) {
+    auto two = comm->split(comm->rank() / 2, comm->rank() % 2);
+    if (comm->rank() / 2 == 0) test_two_ranks(&lib, two);
+    test_rib(comm);
+    OMEGA_H_CHECK(adapt_square(comm) == nserial_elems);
+    OMEGA_H_CHECK(move_perturbed_box(comm) == serial_coord_sum);
+  });
+#endif
   world->barrier();
   test_rib(world);
+  OMEGA_H_CHECK(move_perturbed_box(world) == move_perturbed_box(lib.self()));
 }
@@ -3,13 +3,16 @@
 #include <iostream>
 #include <random>
 
+#include "Omega_h_adapt.hpp"
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_build.hpp"
 #include "Omega_h_eigen.hpp"
 #include "Omega_h_loop.hpp"
+#include "Omega_h_map.hpp"
 #include "Omega_h_mesh.hpp"
 #include "Omega_h_metric.hpp"
 #include "Omega_h_sort.hpp"
+#include "Omega_h_swap3d.hpp"
 #include "Omega_h_timer.hpp"
 
 using namespace Omega_h;
@@ -66,6 +69,26 @@ static void test_metric_decompose(Reals metrics) {
       are_close(Reals(write_eigenvs), Reals(nelems, square(anisotropy))));
 }
 
+static void test_metric_decompose_symm(Reals metrics) {
+  /* the same with the noniterative solver, whose
+     eigenvalues come out in increasing order */
+  Reals eigenvs, eigenvecs;
+  Now t0 = now();
+  Int niters = 3;
+  for (Int i = 0; i < niters; ++i) {
+    decompose_eigens(3, metrics, &eigenvs, &eigenvecs);
+  }
+  Now t1 = now();
+  std::cout << "symmetric eigendecomposition of " << nelems
+            << " metric tensors " << niters << " times takes " << (t1 - t0)
+            << " seconds\n";
+  auto max_eigenvs = Write<Real>(nelems);
+  auto f = OMEGA_H_LAMBDA(Int i) { max_eigenvs[i] = eigenvs[i * 3 + 2]; };
+  parallel_for(nelems, f);
+  OMEGA_H_CHECK(
+      are_close(Reals(max_eigenvs), Reals(nelems, square(anisotropy))));
+}
+
 static void test_metric_invert(Reals metrics) {
   /* now, decompose the metrics and get the largest
      eigenvalue of each */
@@ -86,6 +109,7 @@ static void test_metric_invert(Reals metrics) {
 static void test_metric_math() {
   Reals metrics = random_metrics();
   test_metric_decompose(metrics);
+  test_metric_decompose_symm(metrics);
   test_metric_invert(metrics);
 }
 
@@ -225,10 +249,31 @@ static void test_adjs(Library* lib) {
   test_reflect_down(tets2verts, tris2verts, nverts);
 }
 
+static void test_swap3d_qualities(Library* lib) {
+  auto mesh = build_box(lib->world(), 1, 1, 1, 24, 24, 24);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  add_implied_metric_tag(&mesh);
+  AdaptOpts opts(&mesh);
+  auto edge_class_dims = mesh.get_array<I8>(EDGE, "class_dim");
+  auto cands2edges = collect_marked(each_eq_to(edge_class_dims, I8(3)));
+  Reals cand_quals;
+  Read<I8> cand_configs;
+  swap3d_qualities(&mesh, opts, cands2edges, &cand_quals, &cand_configs);
+  Int niters = 5;
+  Now t0 = now();
+  for (Int i = 0; i < niters; ++i) {
+    swap3d_qualities(&mesh, opts, cands2edges, &cand_quals, &cand_configs);
+  }
+  Now t1 = now();
+  std::cout << "evaluating swaps of " << cands2edges.size() << " edges "
+            << niters << " times takes " << (t1 - t0) << " seconds\n";
+}
+
 int main(int argc, char** argv) {
   auto lib = Library(&argc, &argv);
   test_metric_math();
   test_repro_sum();
   test_sort();
   test_adjs(&lib);
+  test_swap3d_qualities(&lib);
 }
@@ -1,7 +1,9 @@
+#include "Omega_h_adapt.hpp"
 #include "Omega_h_align.hpp"
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_assoc.hpp"
 #include "Omega_h_bbox.hpp"
+#include "Omega_h_coarsen.hpp"
 #include "Omega_h_compare.hpp"
 #include "Omega_h_eigen.hpp"
 #include "Omega_h_hilbert.hpp"
@@ -12,7 +14,9 @@
 #include "Omega_h_motion.hpp"
 #include "Omega_h_proximity.hpp"
 #include "Omega_h_quality.hpp"
+#include "Omega_h_refine.hpp"
 #include "Omega_h_refine_qualities.hpp"
+#include "Omega_h_refine_templates.hpp"
 #include "Omega_h_scan.hpp"
 #include "Omega_h_shape.hpp"
 #include "Omega_h_sort.hpp"
@@ -70,10 +74,29 @@ static void test_int128() {
   OMEGA_H_CHECK(b == a);
 }
 
-static void test_repro_sum() {
+static void test_repro_sum(Library* lib) {
   Reals a({std::exp2(int(20)), std::exp2(int(-20))});
   Real sum = repro_sum(a);
   OMEGA_H_CHECK(sum == std::exp2(20) + std::exp2(int(-20)));
+  /* the unit of the second component is subnormal */
+  Reals b({std::exp2(int(20)), std::exp2(int(-1000)), std::exp2(int(-20)),
+      std::exp2(int(-1010)), -1.0, std::exp2(int(-1020))});
+  Real sums[2];
+  repro_sum(lib->self(), b, 2, sums);
+  OMEGA_H_CHECK(sums[0] == std::exp2(20) + std::exp2(int(-20)) - 1.0);
+  OMEGA_H_CHECK(sums[1] == std::exp2(int(-1000)) + std::exp2(int(-1010)) +
+                               std::exp2(int(-1020)));
+  for (Int comp = 0; comp < 2; ++comp) {
+    auto comp_sum = repro_sum(lib->self(), get_component(b, 2, comp));
+    OMEGA_H_CHECK(comp_sum == sums[comp]);
+  }
+  /* a zero has the frexp() exponent 0, which sets the unit to 2^(-52)
+     even though every other value is smaller */
+  Reals c({std::exp2(int(-60)), 0.0, 0.0, 1.0});
+  repro_sum(lib->self(), c, 2, sums);
+  OMEGA_H_CHECK(sums[0] == 0.0);
+  OMEGA_H_CHECK(sums[1] == 1.0);
+  OMEGA_H_CHECK(repro_sum(Reals({std::exp2(int(-60)), 0.0})) == 0.0);
 }
 
 static void test_power() {
@@ -191,6 +214,42 @@ static void test_eigen_jacobi() {
       vector_3(11, 2, 1));
 }
 
+static void test_eigen_symm(Matrix<3, 3> m, Vector<3> l_expect) {
+  auto ed = decompose_eigen_symm(m);
+  OMEGA_H_CHECK(
+      are_close(transpose(ed.q) * ed.q, identity_matrix<3, 3>(), 1e-8, 1e-8));
+  OMEGA_H_CHECK(are_close(ed.l, l_expect, 1e-8, 1e-8));
+  OMEGA_H_CHECK(are_close(m, compose_ortho(ed.q, ed.l), 1e-8, 1e-8));
+}
+
+static void test_eigen_symm_metric(Vector<3> h) {
+  /* no special angles, which would hide the loss of precision
+     of the cubic near a double root */
+  auto q = rotate(0.3, vector_3(0, 0, 1)) * rotate(1.1, vector_3(0, 1, 0)) *
+           rotate(0.7, vector_3(1, 0, 0));
+  auto l = metric_eigenvalues_from_lengths(h);
+  test_eigen_symm(compose_ortho(q, l), l);
+}
+
+static void test_eigen_symm() {
+  test_eigen_symm(identity_matrix<3, 3>(), vector_3(1, 1, 1));
+  test_eigen_symm(zero_matrix<3, 3>(), vector_3(0, 0, 0));
+  test_eigen_symm(diagonal(vector_3(3, -1, 2)), vector_3(-1, 2, 3));
+  test_eigen_symm(matrix_3x3(2, 0, 0, 0, 3, 4, 0, 4, 9), vector_3(1, 2, 11));
+  /* the eigenvalues come out in increasing order,
+     so the lengths are given in decreasing order */
+  test_eigen_symm_metric(vector_3(1e+3, 1, 1));
+  test_eigen_symm_metric(vector_3(1e+3, 1e+3, 1));
+  test_eigen_symm_metric(vector_3(1, 1, 1e-3));
+  test_eigen_symm_metric(vector_3(1, 1e-2, 1e-3));
+  test_eigen_symm_metric(vector_3(1, 1, 1 - 1e-10));
+  test_eigen_symm_metric(vector_3(1, 1 - 1e-7, 1e-3));
+  Reals l, q;
+  decompose_eigens(3, Reals({2, 3, 9, 0, 4, 0}), &l, &q);
+  OMEGA_H_CHECK(are_close(l, Reals({1, 2, 11})));
+  OMEGA_H_CHECK(q.size() == 9);
+}
+
 static void test_intersect_ortho_metrics(
     Vector<3> h1, Vector<3> h2, Vector<3> hi_expect) {
   auto q =
@@ -314,6 +373,28 @@ static void test_invert_map() {
     OMEGA_H_CHECK(l2hl.a2ab == LOs({0, 2, 4}));
     OMEGA_H_CHECK(l2hl.ab2b == LOs({1, 3, 0, 2}));
   }
+  {
+    LOs hl2l({}, "hl2l");
+    auto l2hl = invert_map_by_counting(hl2l, 4);
+    OMEGA_H_CHECK(l2hl.a2ab == LOs(5, 0));
+    OMEGA_H_CHECK(l2hl.ab2b == LOs({}));
+  }
+  {
+    LOs hl2l({2, 0, 2, 1, 0, 2, 2}, "hl2l");
+    auto l2hl = invert_map_by_counting(hl2l, 4);
+    OMEGA_H_CHECK(l2hl.a2ab == LOs({0, 2, 3, 7, 7}));
+    OMEGA_H_CHECK(l2hl.ab2b == LOs({1, 4, 3, 0, 2, 5, 6}));
+  }
+  {
+    /* long enough to be counted in several blocks */
+    Write<LO> hl2l(1000);
+    auto f = OMEGA_H_LAMBDA(LO hl) { hl2l[hl] = (hl * 7) % 5; };
+    parallel_for(hl2l.size(), f);
+    auto l2hl = invert_map_by_counting(hl2l, 5);
+    auto l2hl2 = invert_map_by_sorting(hl2l, 5);
+    OMEGA_H_CHECK(l2hl.a2ab == l2hl2.a2ab);
+    OMEGA_H_CHECK(l2hl.ab2b == l2hl2.ab2b);
+  }
 }
 
 static void test_invert_adj() {
@@ -551,6 +632,44 @@ static void test_quality() {
   OMEGA_H_CHECK(are_close(metric_element_quality(x_tet, x_metric_3), 1.0));
 }
 
+template <Int dim, typename Metric>
+static void test_quality_gradient(Few<Vector<dim>, dim + 1> p, Metric m) {
+  Real const eps = 1e-6;
+  for (Int v = 0; v <= dim; ++v) {
+    auto grad = metric_element_quality_gradient(p, m, v);
+    for (Int i = 0; i < dim; ++i) {
+      auto pp = p;
+      auto pm = p;
+      pp[v][i] += eps;
+      pm[v][i] -= eps;
+      auto fd = (metric_element_quality(pp, m) -
+                    metric_element_quality(pm, m)) /
+                (2.0 * eps);
+      OMEGA_H_CHECK(are_close(grad[i], fd, 1e-6, 1e-6));
+    }
+  }
+}
+
+static void test_quality_gradient() {
+  Few<Vector<2>, 3> tri({vector_2(0, 0), vector_2(1, 0.2), vector_2(0.3, 0.4)});
+  Few<Vector<3>, 4> tet({vector_3(0, 0, 0), vector_3(1, 0.1, 0),
+      vector_3(0.2, 0.8, 0.1), vector_3(0.3, 0.2, 0.5)});
+  auto r = rotate(PI / 5., normalize(vector_3(1, 2, 3)));
+  auto m2 = compose_metric(rotate(PI / 3.), vector_2(1, 0.2));
+  test_quality_gradient(tri, m2);
+  test_quality_gradient(tet, compose_metric(r, vector_3(1, 0.5, 0.2)));
+  test_quality_gradient(tet, matrix_1x1(4.0));
+  auto inv_tet = tet;
+  swap2(inv_tet[0], inv_tet[1]);
+  test_quality_gradient(inv_tet, identity_matrix<3, 3>());
+  Few<Vector<3>, 4> perfect_tet(
+      {vector_3(1, 0, -1.0 / sqrt(2.0)), vector_3(-1, 0, -1.0 / sqrt(2.0)),
+          vector_3(0, -1, 1.0 / sqrt(2.0)), vector_3(0, 1, 1.0 / sqrt(2.0))});
+  auto g = metric_element_quality_gradient(
+      perfect_tet, identity_matrix<3, 3>(), 0);
+  OMEGA_H_CHECK(are_close(norm(g), 0.0));
+}
+
 static void test_file_components() {
   using namespace binary;
   std::stringstream stream;
@@ -677,6 +796,244 @@ static void test_refine_qualities(Library* lib) {
       quals, Reals({0.494872, 0.494872, 0.866025, 0.494872, 0.494872}), 1e-4));
 }
 
+template <Int dim>
+static void test_refine_template(Int mask, Int diag) {
+  Few<Vector<dim>, 10> tp;
+  for (Int v = 0; v <= dim; ++v) {
+    tp[v] = zero_vector<dim>();
+    if (v) tp[v][v - 1] = 1.0;
+  }
+  for (Int e = 0; e < simplex_degree(dim, EDGE); ++e) {
+    tp[dim + 1 + e] = (tp[down_template(dim, EDGE, e, 0)] +
+                          tp[down_template(dim, EDGE, e, 1)]) /
+                      2.;
+  }
+  Few<Vector<dim>, dim + 1> p;
+  for (Int v = 0; v <= dim; ++v) p[v] = tp[v];
+  auto size = element_size(simplex_basis<dim, dim>(p));
+  Real sum = 0;
+  auto nchildren = count_template_prods(dim, mask, dim);
+  for (Int child = 0; child < nchildren; ++child) {
+    Int ctv2tv[dim + 1];
+    get_template_prod(dim, mask, diag, dim, child, ctv2tv);
+    for (Int ctv = 0; ctv <= dim; ++ctv) p[ctv] = tp[ctv2tv[ctv]];
+    auto child_size = element_size(simplex_basis<dim, dim>(p));
+    OMEGA_H_CHECK(child_size > 0.0);
+    sum += child_size;
+  }
+  OMEGA_H_CHECK(are_close(sum, size));
+}
+
+/* refines a 2x2 box (8 triangles or 48 tets) to a uniform metric
+   (ratio) times finer, returning the number of rebuilds it took */
+static Int count_refine_rebuilds(Library* lib, Int dim, Real ratio,
+    bool with_templates, GO* nelems) {
+  auto mesh = build_box(lib->world(), 1., 1., (dim == 3) ? 1. : 0., 2, 2,
+      (dim == 3) ? 2 : 0);
+  mesh.add_tag(VERT, "metric", 1,
+      Reals(mesh.nverts(), metric_eigenvalue_from_length(0.5 / ratio)));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.should_refine_with_templates = with_templates;
+  Int nrebuilds = 0;
+  while (refine_by_size(&mesh, opts)) ++nrebuilds;
+  *nelems = mesh.nglobal_ents(dim);
+  return nrebuilds;
+}
+
+static void test_refine_templates(Library* lib) {
+  for (Int e = 0; e < 3; ++e) test_refine_template<2>(1 << e, 0);
+  test_refine_template<2>(full_template_mask(2), 0);
+  for (Int e = 0; e < 6; ++e) test_refine_template<3>(1 << e, 0);
+  for (Int f = 0; f < 4; ++f) {
+    OMEGA_H_CHECK(which_template_face(3, face_template_mask(3, f)) == f);
+    test_refine_template<3>(face_template_mask(3, f), 0);
+  }
+  for (Int diag = 0; diag < 3; ++diag) {
+    test_refine_template<3>(full_template_mask(3), diag);
+  }
+  OMEGA_H_CHECK(!is_template_mask(2, 3));
+  OMEGA_H_CHECK(!is_template_mask(3, 3));
+  for (Int dim = 2; dim <= 3; ++dim) {
+    auto mesh = build_box(lib->world(), 1., 1., (dim == 3) ? 1. : 0., 2, 2,
+        (dim == 3) ? 2 : 0);
+    mesh.add_tag(VERT, "metric", 1, Reals(mesh.nverts(), 1.0 / square(0.2)));
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.should_refine_with_templates = true;
+    auto nelems = mesh.nglobal_ents(dim);
+    AdaptStats stats;
+    adapt(&mesh, opts, &stats);
+    OMEGA_H_CHECK(mesh.nglobal_ents(dim) > nelems);
+    OMEGA_H_CHECK(stats.nrefined_edges > 0);
+    OMEGA_H_CHECK(mesh.min_quality() >= opts.min_quality_allowed);
+  }
+  /* templates halve every long edge per rebuild, and the diagonals
+     of the box, up to sqrt(3) times longer, need at most one more */
+  for (Int dim = 2; dim <= 3; ++dim) {
+    Real ratio = 4.0;
+    GO nindset_elems, ntemplate_elems;
+    auto nindset_rebuilds =
+        count_refine_rebuilds(lib, dim, ratio, false, &nindset_elems);
+    auto ntemplate_rebuilds =
+        count_refine_rebuilds(lib, dim, ratio, true, &ntemplate_elems);
+    OMEGA_H_CHECK(ntemplate_elems == nindset_elems);
+    auto max_template_rebuilds = Int(std::ceil(std::log2(ratio))) + 1;
+    OMEGA_H_CHECK(ntemplate_rebuilds <= max_template_rebuilds);
+    OMEGA_H_CHECK(nindset_rebuilds >= 2 * ntemplate_rebuilds);
+  }
+}
+
+/* a unit square with an anisotropic metric graded along X */
+static Mesh build_graded_metric_square(Library* lib) {
+  auto mesh = build_box(lib->world(), 1., 1., 0., 4, 4, 0);
+  auto coords = mesh.coords();
+  Write<Real> metrics(mesh.nverts() * symm_ncomps(2));
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    auto h = vector_2(0.05 + 0.2 * x[0], 0.3);
+    set_symm(metrics, v, diagonal(metric_eigenvalues_from_lengths(h)));
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "metric", symm_ncomps(2), Reals(metrics));
+  return mesh;
+}
+
+static void test_log_metric(Library* lib) {
+  auto mesh = build_graded_metric_square(lib);
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.should_store_log_metric = true;
+  adapt(&mesh, opts);
+  OMEGA_H_CHECK(mesh.has_tag(VERT, "log_metric"));
+  auto log_metrics = mesh.get_array<Real>(VERT, "log_metric");
+  auto expected =
+      linearize_metrics(mesh.nverts(), mesh.get_array<Real>(VERT, "metric"));
+  OMEGA_H_CHECK(are_close(log_metrics, expected));
+  mesh.set_tag(VERT, "metric", mesh.get_array<Real>(VERT, "metric"));
+  OMEGA_H_CHECK(!mesh.has_tag(VERT, "log_metric"));
+}
+
+static void test_mident_metric(Library* lib) {
+  auto mesh = build_graded_metric_square(lib);
+  add_mident_metric_tag(&mesh);
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  OMEGA_H_CHECK(refine_by_size(&mesh, opts));
+  OMEGA_H_CHECK(mesh.has_tag(EDGE, "mident_metric"));
+  auto expected =
+      get_mident_metrics(&mesh, EDGE, mesh.get_array<Real>(VERT, "metric"));
+  OMEGA_H_CHECK(mesh.get_array<Real>(EDGE, "mident_metric") == expected);
+  mesh.set_tag(VERT, "metric", mesh.get_array<Real>(VERT, "metric"));
+  OMEGA_H_CHECK(!mesh.has_tag(EDGE, "mident_metric"));
+}
+
+/* the limiter only revisits the vertices near the last changes */
+static void test_gradation_front(Library* lib) {
+  auto mesh = build_box(lib->world(), 1., 1., 0., 16, 16, 0);
+  auto nverts = mesh.nverts();
+  GO nupdates;
+  auto uniform = Reals(nverts, 1.0 / square(0.1));
+  auto limited = limit_metric_gradation(&mesh, uniform, 1.0, 1e-3, false,
+      &nupdates);
+  OMEGA_H_CHECK(limited == uniform);
+  OMEGA_H_CHECK(nupdates == GO(nverts));
+  auto coords = mesh.coords();
+  Write<Real> point(nverts);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    auto h = (norm(x) < 1e-6) ? 1e-3 : 0.5;
+    point[v] = metric_eigenvalue_from_length(h);
+  };
+  parallel_for(nverts, f);
+  limited = limit_metric_gradation(&mesh, Reals(point), 1.0, 1e-3, false,
+      &nupdates);
+  OMEGA_H_CHECK(get_max(limited) == metric_eigenvalue_from_length(1e-3));
+  /* the refinement spreads over 8 steps, which would be
+     8 * nverts updates for full sweeps */
+  OMEGA_H_CHECK(nupdates > GO(nverts));
+  OMEGA_H_CHECK(nupdates < GO(2 * nverts));
+}
+
+static Int count_metric_passes(
+    Mesh* mesh, Real max_nelems, bool closed_form) {
+  MetricInput input;
+  input.verbose = false;
+  input.sources.push_back(MetricSource(OMEGA_H_GIVEN, 1.0, "target"));
+  input.should_limit_gradation = true;
+  input.max_gradation_rate = 0.2;
+  input.should_limit_element_count = true;
+  input.max_element_count = max_nelems;
+  input.min_element_count = 0.8 * max_nelems;
+  input.should_scale_element_count_in_closed_form = closed_form;
+  Int npasses;
+  auto metrics = generate_metrics(mesh, input, &npasses);
+  auto nelems = get_expected_nelems(mesh, metrics);
+  OMEGA_H_CHECK(input.min_element_count <= nelems);
+  OMEGA_H_CHECK(nelems <= input.max_element_count);
+  return npasses;
+}
+
+/* the closed-form element count scaling limits gradation at most
+   twice and still lands in range, where the regular loop takes more */
+static void test_closed_form_element_count(Library* lib) {
+  auto mesh = build_box(lib->world(), 1., 1., 0., 16, 16, 0);
+  auto coords = mesh.coords();
+  Write<Real> target(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    target[v] = metric_eigenvalue_from_length(0.001 + 0.5 * norm_squared(x));
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "target", 1, Reals(target));
+  OMEGA_H_CHECK(count_metric_passes(&mesh, 100.0, false) > 2);
+  OMEGA_H_CHECK(count_metric_passes(&mesh, 100.0, true) <= 2);
+  OMEGA_H_CHECK(count_metric_passes(&mesh, 1000.0, false) > 2);
+  OMEGA_H_CHECK(count_metric_passes(&mesh, 1000.0, true) <= 2);
+}
+
+/* coarsens a box with the pointwise tags "p" and "q", which vary
+   in space and between components, transferring only (names) */
+static Mesh coarsen_with_tags(
+    Library* lib, std::vector<std::string> const& names) {
+  auto mesh = build_box(lib->world(), 1., 1., 0., 4, 4, 0);
+  mesh.add_tag(VERT, "metric", 1, Reals(mesh.nverts(), 1.0 / square(0.5)));
+  auto elems2verts = mesh.ask_elem_verts();
+  auto coords = mesh.coords();
+  Write<Real> p(mesh.nelems());
+  Write<Real> q(mesh.nelems() * 2);
+  auto f = OMEGA_H_LAMBDA(LO e) {
+    auto v = gather_verts<3>(elems2verts, e);
+    auto x = average(gather_vectors<3, 2>(coords, v));
+    p[e] = x[0] + 2.0 * x[1];
+    q[e * 2 + 0] = x[0] * x[1];
+    q[e * 2 + 1] = 1.0 - 3.0 * x[0];
+  };
+  parallel_for(mesh.nelems(), f);
+  mesh.add_tag(TRI, "p", 1, Reals(p));
+  mesh.add_tag(TRI, "q", 2, Reals(q));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  for (auto& name : names) opts.xfer_opts.type_map[name] = OMEGA_H_POINTWISE;
+  OMEGA_H_CHECK(coarsen_by_size(&mesh, opts));
+  return mesh;
+}
+
+/* fitted tags are transferred together through one packed array,
+   which should give what transferring each tag alone gives */
+static void test_packed_transfer(Library* lib) {
+  auto packed = coarsen_with_tags(lib, {"p", "q"});
+  auto p_alone = coarsen_with_tags(lib, {"p"});
+  auto q_alone = coarsen_with_tags(lib, {"q"});
+  OMEGA_H_CHECK(packed.nelems() == p_alone.nelems());
+  OMEGA_H_CHECK(packed.nelems() == q_alone.nelems());
+  auto p = packed.get_array<Real>(TRI, "p");
+  auto q = packed.get_array<Real>(TRI, "q");
+  OMEGA_H_CHECK(get_min(p) < get_max(p));
+  OMEGA_H_CHECK(p == p_alone.get_array<Real>(TRI, "p"));
+  OMEGA_H_CHECK(q == q_alone.get_array<Real>(TRI, "q"));
+}
+
 static void test_mark_up_down(Library* lib) {
   auto mesh = Mesh(lib);
   build_box_internal(&mesh, 1., 1., 0., 1, 1, 0);
@@ -981,6 +1338,48 @@ static void test_motion(Library* lib) {
   OMEGA_H_CHECK(mesh.min_quality() == choices.quals.get(0));
 }
 
+/* moves the interior vertices of a perturbed box along quality
+   gradients, which should raise the minimum quality without making
+   any edge longer than the longest one of the perturbed box */
+static void test_motion_with_gradient(Library* lib) {
+  auto mesh = build_box(lib->world(), 1., 1., 1., 4, 4, 4);
+  mesh.add_tag(VERT, "metric", 1, get_implied_isos(&mesh));
+  auto class_dims = mesh.get_array<I8>(VERT, "class_dim");
+  auto coords = mesh.coords();
+  Write<Real> perturbed_w(coords.size());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<3>(coords, v);
+    auto y = x;
+    if (class_dims[v] == 3) {
+      y[0] += 0.03 * std::sin(17.0 * x[1] + 3.0 * x[2]);
+      y[1] += 0.03 * std::sin(13.0 * x[2] + 5.0 * x[0]);
+      y[2] += 0.03 * std::sin(11.0 * x[0] + 7.0 * x[1]);
+    }
+    set_vector(perturbed_w, v, y);
+  };
+  parallel_for(mesh.nverts(), f);
+  auto perturbed = Reals(perturbed_w);
+  mesh.set_coords(perturbed);
+  AdaptOpts opts(&mesh);
+  opts.should_move_with_gradient = true;
+  opts.min_quality_desired = 0.8;
+  opts.max_length_allowed = mesh.max_length();
+  opts.verbosity = SILENT;
+  auto old_minqual = mesh.min_quality();
+  OMEGA_H_CHECK(old_minqual < opts.min_quality_desired);
+  for (Int i = 0; i < 3; ++i) {
+    if (!move_verts_for_quality(&mesh, opts)) break;
+    auto minqual = mesh.min_quality();
+    OMEGA_H_CHECK(minqual >= old_minqual);
+    OMEGA_H_CHECK(mesh.max_length() <= opts.max_length_allowed);
+    old_minqual = minqual;
+  }
+  auto moved = each_neq_to(
+      get_vector_norms(subtract_each(mesh.coords(), perturbed), 3), 0.0);
+  auto interior_moved = land_each(moved, each_eq_to(class_dims, I8(3)));
+  OMEGA_H_CHECK(get_max(interior_moved) == 1);
+}
+
 static void test_find_last() {
   auto a = LOs({0, 3, 55, 12});
   OMEGA_H_CHECK(find_last(a, 98) < 0);
@@ -1132,9 +1531,10 @@ int main(int argc, char** argv) {
   test_eigen_quadratic();
   test_eigen_cubic();
   test_eigen_jacobi();
+  test_eigen_symm();
   test_least_squares();
   test_int128();
-  test_repro_sum();
+  test_repro_sum(&lib);
   test_sort();
   test_scan();
   test_intersect_metrics();
@@ -1153,6 +1553,7 @@ int main(int argc, char** argv) {
   test_injective_map();
   test_dual(&lib);
   test_quality();
+  test_quality_gradient();
   test_file_components();
   test_linpart();
   test_expand();
@@ -1160,6 +1561,12 @@ int main(int argc, char** argv) {
   test_average_field(&lib);
   test_positivize();
   test_refine_qualities(&lib);
+  test_refine_templates(&lib);
+  test_log_metric(&lib);
+  test_mident_metric(&lib);
+  test_gradation_front(&lib);
+  test_closed_form_element_count(&lib);
+  test_packed_transfer(&lib);
   test_mark_up_down(&lib);
   test_compare_meshes(&lib);
   test_swap2d_topology(&lib);
@@ -1175,6 +1582,7 @@ int main(int argc, char** argv) {
   test_lie();
   test_proximity(&lib);
   test_motion(&lib);
+  test_motion_with_gradient(&lib);
   test_find_last();
   test_inball();
   test_volume_vert_gradients();